@@ -0,0 +1,392 @@
+/** @file bench_priqueue.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <stddef.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "libpriqueue/libpriqueue.h"
+
+typedef enum {PATTERN_ASCENDING = 0, PATTERN_DESCENDING, PATTERN_RANDOM, PATTERN_TIES} pattern_t;
+
+static const char *pattern_names[] = { "ascending", "descending", "random", "ties" };
+static const char *engine_names[] = { "list", "heap", "tree" };
+
+typedef struct _item_t
+{
+	int key;
+	int slot;
+} item_t;
+
+typedef struct _bench_t
+{
+	FILE *out;
+	int records;
+	double budget;        // seconds a single measurement may take
+	uint64_t random;      // xorshift64 state
+} bench_t;
+
+/*
+ * One thread of a throughput measurement, on a shared queue: either a heap priqueue_t behind one mutex, or a
+ * cpriqueue_t.
+ */
+typedef struct _bench_thread_t
+{
+	priqueue_t *q;
+	pthread_mutex_t *lock;
+	cpriqueue_t *cq;
+	uint64_t random;      // xorshift64 state of the new keys
+	int *stop;
+	long ops;
+} bench_thread_t;
+
+#define THREAD_QUEUE_SIZE 10000
+
+int compare_items(const void *a, const void *b)
+{
+	int x = ((const item_t *)a)->key, y = ((const item_t *)b)->key;
+	return (x > y) - (x < y);
+}
+
+void print_usage(char *program_name)
+{
+	fprintf(stderr, "Usage: %s [-e list|heap|tree] [-n <max size>] [-t <seconds>] [-S <seed>] [-T <threads>] [-o <file>]\n", program_name);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Times priqueue_offer, poll, at, remove and remove_at on queues of 10, 100, ...\n");
+	fprintf(stderr, "up to <max size> (default: 10000000) elements, filled in ascending, descending,\n");
+	fprintf(stderr, "random and many-ties key order, and writes the results as JSON.\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "  -e  only this engine (default: all)\n");
+	fprintf(stderr, "  -t  time budget of one measurement (default: 0.25); operations that would take\n");
+	fprintf(stderr, "      longer are measured on fewer elements, and a queue that cannot be filled\n");
+	fprintf(stderr, "      within ten budgets stops that engine and pattern from growing further\n");
+	fprintf(stderr, "  -S  seed of the random and ties patterns and of the indexes used (default: 1)\n");
+	fprintf(stderr, "  -T  then time polls and offers from 1, 2, 4, ... up to <threads> threads on one\n");
+	fprintf(stderr, "      shared heap behind a mutex and on a cpriqueue_t with two parts per thread, for\n");
+	fprintf(stderr, "      one budget each (default: one thread per online CPU, 0 to skip)\n");
+	fprintf(stderr, "  -o  output file (default: stdout)\n");
+}
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+uint64_t next_random(bench_t *bench)
+{
+	bench->random ^= bench->random << 13;
+	bench->random ^= bench->random >> 7;
+	bench->random ^= bench->random << 17;
+	return bench->random;
+}
+
+void report(bench_t *bench, priqueue_engine_t engine, pattern_t pattern, int size, const char *op, long ops, double seconds)
+{
+	if (ops == 0)
+		return;
+
+	fprintf(bench->out, "%s\n    {\"engine\": \"%s\", \"pattern\": \"%s\", \"size\": %d, \"op\": \"%s\", \"ops\": %ld, \"ns_per_op\": %.2f, \"ops_per_sec\": %.0f}",
+			bench->records++ ? "," : "", engine_names[engine], pattern_names[pattern], size, op, ops,
+			seconds * 1e9 / ops, (seconds > 0) ? ops / seconds : 0.0);
+}
+
+/*
+ * Measures every operation on one queue of size elements.  Returns 0 if the queue could not be filled in time.
+ */
+int bench_size(bench_t *bench, priqueue_engine_t engine, pattern_t pattern, int size)
+{
+	item_t *items = malloc(size * sizeof(item_t));
+	int *picked = malloc(size * sizeof(int));
+	priqueue_t q;
+	long i, ops;
+	double start, elapsed;
+	int filled = 1;
+
+	for (i = 0; i < size; i++)
+	{
+		if (pattern == PATTERN_ASCENDING) { items[i].key = i; }
+		else if (pattern == PATTERN_DESCENDING) { items[i].key = size - i; }
+		else if (pattern == PATTERN_RANDOM) { items[i].key = next_random(bench) >> 33; }
+		else { items[i].key = next_random(bench) % 16; }
+		items[i].slot = -1;
+	}
+
+	priqueue_init_engine(&q, compare_items, engine);
+	priqueue_set_slot(&q, offsetof(item_t, slot));
+
+	// offer: fill the queue
+	start = now();
+	for (i = 0; i < size; i++)
+	{
+		priqueue_offer(&q, &items[i]);
+		if ((i & 1023) == 1023 && now() - start > 10 * bench->budget)
+		{
+			i++;
+			filled = 0;
+			break;
+		}
+	}
+	report(bench, engine, pattern, size, "offer", i, now() - start);
+
+	if (filled)
+	{
+		// at: random indexes of an unchanged queue
+		start = now();
+		for (ops = 0; ops < size && ((ops & 63) || now() - start < bench->budget); ops++)
+			priqueue_at(&q, next_random(bench) % size);
+		report(bench, engine, pattern, size, "at", ops, now() - start);
+
+		// remove: random elements by address, then put them back
+		for (i = 0; i < size; i++)
+			picked[i] = i;
+
+		start = now();
+		for (ops = 0; ops < size / 2 + 1 && ops < size && ((ops & 63) || now() - start < bench->budget); ops++)
+		{
+			long j = ops + next_random(bench) % (size - ops);
+			int swap = picked[ops];
+			picked[ops] = picked[j];
+			picked[j] = swap;
+
+			priqueue_remove(&q, &items[picked[ops]]);
+		}
+		elapsed = now() - start;
+		report(bench, engine, pattern, size, "remove", ops, elapsed);
+
+		for (i = 0; i < ops; i++)
+			priqueue_offer(&q, &items[picked[i]]);
+
+		// remove_at: random indexes, then put the elements back
+		start = now();
+		for (ops = 0; ops < size / 2 + 1 && ops < size && ((ops & 63) || now() - start < bench->budget); ops++)
+			picked[ops] = (item_t *)priqueue_remove_at(&q, next_random(bench) % (size - ops)) - items;
+		elapsed = now() - start;
+		report(bench, engine, pattern, size, "remove_at", ops, elapsed);
+
+		for (i = 0; i < ops; i++)
+			priqueue_offer(&q, &items[picked[i]]);
+
+		// poll: drain the queue
+		start = now();
+		for (ops = 0; ops < size && ((ops & 1023) || now() - start < bench->budget); ops++)
+			priqueue_poll(&q);
+		report(bench, engine, pattern, size, "poll", ops, now() - start);
+	}
+
+	priqueue_destroy(&q);
+	free(picked);
+	free(items);
+
+	return filled;
+}
+
+/*
+ * Polls an element off the shared queue and offers it back with a new key until told to stop.
+ */
+void *bench_thread(void *arg)
+{
+	bench_thread_t *t = arg;
+
+	while (!__atomic_load_n(t->stop, __ATOMIC_RELAXED))
+	{
+		item_t *item;
+
+		t->random ^= t->random << 13;
+		t->random ^= t->random >> 7;
+		t->random ^= t->random << 17;
+
+		if (t->cq != NULL)
+		{
+			item = cpriqueue_poll(t->cq);
+			if (item != NULL)
+			{
+				item->key = t->random >> 33;
+				cpriqueue_offer(t->cq, item);
+			}
+		}
+		else
+		{
+			pthread_mutex_lock(t->lock);
+			item = priqueue_poll(t->q);
+			if (item != NULL)
+			{
+				item->key = t->random >> 33;
+				priqueue_offer(t->q, item);
+			}
+			pthread_mutex_unlock(t->lock);
+		}
+		t->ops += 2;
+	}
+
+	return NULL;
+}
+
+/*
+ * Measures poll and offer pairs from threads threads on a shared queue of THREAD_QUEUE_SIZE elements, locked or
+ * concurrent.
+ */
+void bench_threads(bench_t *bench, int threads, int concurrent)
+{
+	item_t *items = malloc(THREAD_QUEUE_SIZE * sizeof(item_t));
+	bench_thread_t *workers = calloc(threads, sizeof(bench_thread_t));
+	pthread_t *ids = malloc(threads * sizeof(pthread_t));
+	pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+	priqueue_t q;
+	cpriqueue_t cq;
+	int stop = 0, i;
+	long ops = 0;
+
+	priqueue_init_engine(&q, compare_items, PRIQUEUE_HEAP);
+	cpriqueue_init(&cq, compare_items, 2 * threads);
+
+	for (i = 0; i < THREAD_QUEUE_SIZE; i++)
+	{
+		items[i].key = next_random(bench) >> 33;
+		items[i].slot = -1;
+		if (concurrent)
+			cpriqueue_offer(&cq, &items[i]);
+		else
+			priqueue_offer(&q, &items[i]);
+	}
+
+	double start = now();
+	for (i = 0; i < threads; i++)
+	{
+		workers[i].q = &q;
+		workers[i].lock = &lock;
+		workers[i].cq = concurrent ? &cq : NULL;
+		workers[i].random = next_random(bench) | 1;
+		workers[i].stop = &stop;
+		pthread_create(&ids[i], NULL, bench_thread, &workers[i]);
+	}
+
+	struct timespec budget = { (time_t)bench->budget, (long)((bench->budget - (time_t)bench->budget) * 1e9) };
+	nanosleep(&budget, NULL);
+	__atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+
+	for (i = 0; i < threads; i++)
+	{
+		pthread_join(ids[i], NULL);
+		ops += workers[i].ops;
+	}
+	double seconds = now() - start;
+
+	fprintf(bench->out, "%s\n    {\"engine\": \"%s\", \"threads\": %d, \"size\": %d, \"op\": \"poll+offer\", \"ops\": %ld, \"ns_per_op\": %.2f, \"ops_per_sec\": %.0f}",
+			bench->records++ ? "," : "", concurrent ? "cpriqueue" : "locked-heap", threads, THREAD_QUEUE_SIZE, ops,
+			(ops > 0) ? seconds * 1e9 / ops : 0.0, ops / seconds);
+
+	cpriqueue_destroy(&cq);
+	priqueue_destroy(&q);
+	pthread_mutex_destroy(&lock);
+	free(ids);
+	free(workers);
+	free(items);
+}
+
+int main(int argc, char **argv)
+{
+	int c, engine, pattern;
+	int engines[3] = { 1, 1, 1 };
+	long max_size = 10000000;
+	long max_threads = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+	char *output_name = NULL;
+
+	bench_t bench;
+	bench.records = 0;
+	bench.budget = 0.25;
+	bench.random = 1;
+
+	while ((c = getopt(argc, argv, "e:n:t:S:T:o:")) != -1)
+	{
+		switch (c)
+		{
+			case 'e':
+				for (engine = PRIQUEUE_LIST; engine <= PRIQUEUE_TREE; engine++)
+					engines[engine] = (strcasecmp(optarg, engine_names[engine]) == 0);
+				if (!engines[PRIQUEUE_LIST] && !engines[PRIQUEUE_HEAP] && !engines[PRIQUEUE_TREE])
+				{
+					fprintf(stderr, "Option -e <engine> requires list, heap or tree.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'n': max_size = atol(optarg); break;
+			case 't': bench.budget = atof(optarg); break;
+			case 'S': bench.random = strtoull(optarg, NULL, 10) * 2 + 1; break;
+			case 'T': max_threads = atol(optarg); break;
+			case 'o': output_name = optarg; break;
+
+			default:
+				print_usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if (max_size < 10 || max_size > 1000000000 || bench.budget <= 0 || max_threads < 0 || max_threads > 4096)
+	{
+		fprintf(stderr, "Options need -n from 10 to 1000000000, -t above 0 and -T from 0 to 4096.\n");
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	bench.out = (output_name == NULL) ? stdout : fopen(output_name, "w");
+	if (bench.out == NULL)
+	{
+		fprintf(stderr, "Unable to write file \"%s\".\n", output_name);
+		return 2;
+	}
+
+	fprintf(bench.out, "{\n  \"benchmark\": \"priqueue\",\n  \"budget_seconds\": %g,\n  \"results\": [", bench.budget);
+
+	for (engine = PRIQUEUE_LIST; engine <= PRIQUEUE_TREE; engine++)
+	{
+		if (!engines[engine])
+			continue;
+
+		for (pattern = PATTERN_ASCENDING; pattern <= PATTERN_TIES; pattern++)
+		{
+			long size;
+			for (size = 10; size <= max_size; size *= 10)
+			{
+				if (!bench_size(&bench, engine, pattern, size))
+				{
+					fprintf(stderr, "%s/%s: filling %ld elements ran out of time, larger sizes skipped.\n",
+							engine_names[engine], pattern_names[pattern], size);
+					break;
+				}
+				fflush(bench.out);
+			}
+		}
+	}
+
+	// 1, 2, 4, ... threads, and max_threads itself
+	long threads;
+	for (threads = 1; threads < 2 * max_threads; threads *= 2)
+	{
+		if (threads > max_threads)
+			threads = max_threads;
+
+		bench_threads(&bench, threads, 0);
+		bench_threads(&bench, threads, 1);
+		fflush(bench.out);
+	}
+
+	fprintf(bench.out, "\n  ]\n}\n");
+
+	if (bench.out != stdout && fclose(bench.out) != 0)
+	{
+		fprintf(stderr, "Unable to write file \"%s\".\n", output_name);
+		return 2;
+	}
+
+	return 0;
+}
@@ -0,0 +1,423 @@
+/** @file bench_scheduler.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libscheduler/libscheduler.h"
+
+#define CALL_NEW_JOB 0
+#define CALL_JOB_FINISHED 1
+#define CALL_QUANTUM_EXPIRED 2
+#define CALL_KINDS 3
+
+static const char *scheme_names[] = { "fcfs", "sjf", "psjf", "pri", "ppri", "rr", "mlfq", "edf", "cfs", "stride", "lottery" };
+static const char *engine_names[] = { "list", "heap", "tree" };
+static const char *call_names[] = { "new_job", "job_finished", "quantum_expired" };
+static const int core_counts[] = { 1, 4, 16, 64, 256 };
+
+typedef struct _bench_t
+{
+	FILE *out;
+	int records;
+	int jobs, quantum, mean_run_time;
+	double load;            // offered work per core per time unit
+	uint64_t seed;
+	scheduler_config_t config;   // queue engine set per run
+} bench_t;
+
+/*
+ * Per-call latencies of one kind of call.
+ */
+typedef struct _bench_calls_t
+{
+	uint32_t *ns;
+	long length, capacity;
+	double total;           // seconds spent inside the calls
+} bench_calls_t;
+
+/*
+ * A generated workload: job i arrives at arrival[i] and needs run_time[i] time units.
+ */
+typedef struct _bench_workload_t
+{
+	int *arrival, *run_time, *priority;
+} bench_workload_t;
+
+void print_usage(char *program_name)
+{
+	fprintf(stderr, "Usage: %s [-n <jobs>] [-u <load>] [-m <mean run time>] [-q <quantum>] [-Q list|heap|tree] [-s <scheme>] [-S <seed>] [-W <affinity>] [-o <file>]\n", program_name);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Replays a generated stream of arrivals, finishes and quantum expiries straight\n");
+	fprintf(stderr, "into libscheduler for every scheme at 1, 4, 16, 64 and 256 cores, timing each\n");
+	fprintf(stderr, "call, and writes decisions per second and p50/p99/p999 latencies as JSON.\n");
+	fprintf(stderr, "Decisions per second count time spent inside the scheduler only.\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "  -n  jobs per run (default: 100000)\n");
+	fprintf(stderr, "  -u  offered load per core; above 1 the queue keeps growing (default: 0.95)\n");
+	fprintf(stderr, "  -m  mean of the exponential run times (default: 1000)\n");
+	fprintf(stderr, "  -q  quantum of RR and of the top of 3 MLFQ levels, doubling per level, and the\n");
+	fprintf(stderr, "      minimum granularity of CFS, with a latency of 8 quanta, and of stride and lottery\n");
+	fprintf(stderr, "      (default: 100)\n");
+	fprintf(stderr, "  -Q  only this queue engine (default: all)\n");
+	fprintf(stderr, "  -s  only this scheme: fcfs, sjf, psjf, pri, ppri, rr, mlfq, edf, cfs, stride or lottery\n");
+	fprintf(stderr, "  -S  seed of the workload and of the lottery (default: 1)\n");
+	fprintf(stderr, "  -W  per-core run queues with work stealing, see scheduler_work_stealing();\n");
+	fprintf(stderr, "      the affinity is written as -1 without (default: one shared queue)\n");
+	fprintf(stderr, "  -o  output file (default: stdout)\n");
+}
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Uniform double in (0, 1], from a xorshift64 state.
+ */
+double next_uniform(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return ((*state >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ * Exponential variate of the given mean.
+ */
+double next_exponential(uint64_t *state, double mean)
+{
+	return -log(next_uniform(state)) * mean;
+}
+
+void generate_workload(bench_t *bench, int cores, bench_workload_t *w)
+{
+	uint64_t state = bench->seed * 2 + 1;
+	double time = 0, gap = bench->mean_run_time / (bench->load * cores);
+	int i;
+
+	w->arrival = malloc(bench->jobs * sizeof(int));
+	w->run_time = malloc(bench->jobs * sizeof(int));
+	w->priority = malloc(bench->jobs * sizeof(int));
+
+	for (i = 0; i < bench->jobs; i++)
+	{
+		time += next_exponential(&state, gap);
+		w->arrival[i] = (int)time;
+		w->run_time[i] = (int)next_exponential(&state, bench->mean_run_time) + 1;
+		w->priority[i] = (int)(next_uniform(&state) * 8);
+	}
+}
+
+void free_workload(bench_workload_t *w)
+{
+	free(w->arrival);
+	free(w->run_time);
+	free(w->priority);
+}
+
+void record_call(bench_calls_t *calls, double start, double end)
+{
+	if (calls->length == calls->capacity)
+	{
+		calls->capacity = calls->capacity ? 2 * calls->capacity : 4096;
+		calls->ns = realloc(calls->ns, calls->capacity * sizeof(uint32_t));
+	}
+
+	double ns = (end - start) * 1e9;
+	calls->ns[calls->length++] = (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)ns;
+	calls->total += end - start;
+}
+
+int compare_ns(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+/*
+ * Writes one JSON record; sorts the latencies of calls in place.
+ */
+void report(bench_t *bench, priqueue_engine_t engine, int scheme, int cores, const char *op, bench_calls_t *calls, double mean_waiting)
+{
+	long n = calls->length;
+
+	if (n == 0)
+		return;
+
+	qsort(calls->ns, n, sizeof(uint32_t), compare_ns);
+
+	fprintf(bench->out, "%s\n    {\"engine\": \"%s\", \"scheme\": \"%s\", \"cores\": %d, \"op\": \"%s\", \"calls\": %ld, "
+			"\"decisions_per_sec\": %.0f, \"p50_ns\": %u, \"p99_ns\": %u, \"p999_ns\": %u, \"max_ns\": %u, \"mean_waiting_jobs\": %.1f}",
+			bench->records++ ? "," : "", engine_names[engine], scheme_names[scheme], cores, op, n,
+			(calls->total > 0) ? n / calls->total : 0.0,
+			calls->ns[n / 2], calls->ns[n * 99 / 100], calls->ns[n * 999 / 1000], calls->ns[n - 1], mean_waiting);
+}
+
+/*
+ * Replays the workload against one scheduler.  Every core runs its job from
+ * started[core] with remaining[job] time units left at that point; at each
+ * time, finishes are delivered first, then quantum expiries, then arrivals,
+ * in the same order as the simulator.
+ */
+void bench_run(bench_t *bench, priqueue_engine_t engine, int scheme, int cores, const bench_workload_t *w)
+{
+	bench_calls_t calls[CALL_KINDS], all;
+	int *core_job = malloc(cores * sizeof(int));
+	int *started = malloc(cores * sizeof(int));
+	int *slice = malloc(cores * sizeof(int));       // quantum of each core's job, 0 if it runs to completion
+	int *remaining = malloc(bench->jobs * sizeof(int));
+	int quantum = (scheme == RR) ? bench->quantum : 0;
+	int next = 0, finished = 0, busy = 0, time, i, k;
+	double waiting_sum = 0, start;
+
+	memset(calls, 0, sizeof(calls));
+	memset(&all, 0, sizeof(all));
+
+	for (i = 0; i < cores; i++)
+	{
+		core_job[i] = -1;
+		slice[i] = 0;
+	}
+	memcpy(remaining, w->run_time, bench->jobs * sizeof(int));
+
+	bench->config.queue_engine = engine;
+	scheduler_t *s = scheduler_create_ex(cores, scheme, &bench->config);
+
+	while (finished < bench->jobs)
+	{
+		// next event: an arrival, a finish or a quantum expiry
+		time = (next < bench->jobs) ? w->arrival[next] : -1;
+		for (i = 0; i < cores; i++)
+		{
+			if (core_job[i] == -1)
+				continue;
+
+			int event = started[i] + remaining[core_job[i]];
+			if (slice[i] && started[i] + slice[i] < event)
+				event = started[i] + slice[i];
+			if (time == -1 || event < time)
+				time = event;
+		}
+
+		for (i = 0; i < cores; i++)
+		{
+			int job = core_job[i];
+			if (job == -1 || started[i] + remaining[job] != time)
+				continue;
+
+			start = now();
+			int chosen = scheduler_job_finished_r(s, i, job, time);
+			record_call(&calls[CALL_JOB_FINISHED], start, now());
+			waiting_sum += next - finished - busy;
+
+			finished++;
+			remaining[job] = 0;
+			core_job[i] = chosen;
+			started[i] = time;
+			slice[i] = quantum ? quantum : scheduler_time_slice_r(s, i);
+			if (chosen == -1)
+				busy--;
+		}
+
+		for (i = 0; i < cores; i++)
+		{
+			int job = core_job[i];
+			if (job == -1 || !slice[i] || started[i] + slice[i] != time)
+				continue;
+
+			start = now();
+			int chosen = scheduler_quantum_expired_r(s, i, time);
+			record_call(&calls[CALL_QUANTUM_EXPIRED], start, now());
+			waiting_sum += next - finished - busy;
+
+			remaining[job] -= time - started[i];
+			core_job[i] = chosen;
+			started[i] = time;
+			slice[i] = quantum ? quantum : scheduler_time_slice_r(s, i);
+			if (chosen == -1)
+				busy--;
+		}
+
+		while (next < bench->jobs && w->arrival[next] == time)
+		{
+			start = now();
+			int core = scheduler_new_job_r(s, next, time, w->run_time[next], w->priority[next]);
+			record_call(&calls[CALL_NEW_JOB], start, now());
+			waiting_sum += next - finished - busy;
+
+			if (core != -1)
+			{
+				if (core_job[core] == -1)
+					busy++;
+				else
+					remaining[core_job[core]] -= time - started[core];
+
+				core_job[core] = next;
+				started[core] = time;
+				slice[core] = quantum ? quantum : scheduler_time_slice_r(s, core);
+			}
+			next++;
+		}
+	}
+
+	scheduler_destroy(s);
+
+	long total = 0;
+	for (k = 0; k < CALL_KINDS; k++)
+		total += calls[k].length;
+
+	all.ns = malloc(total * sizeof(uint32_t));
+	for (k = 0; k < CALL_KINDS; k++)
+	{
+		memcpy(all.ns + all.length, calls[k].ns, calls[k].length * sizeof(uint32_t));
+		all.length += calls[k].length;
+		all.total += calls[k].total;
+	}
+
+	report(bench, engine, scheme, cores, "all", &all, waiting_sum / total);
+	for (k = 0; k < CALL_KINDS; k++)
+	{
+		report(bench, engine, scheme, cores, call_names[k], &calls[k], waiting_sum / total);
+		free(calls[k].ns);
+	}
+
+	free(all.ns);
+	free(remaining);
+	free(slice);
+	free(started);
+	free(core_job);
+}
+
+int main(int argc, char **argv)
+{
+	int c, engine, scheme, i;
+	int engines[3] = { 1, 1, 1 };
+	int only_scheme = -1, affinity = -1;
+	char *output_name = NULL;
+
+	bench_t bench;
+	bench.records = 0;
+	bench.jobs = 100000;
+	bench.load = 0.95;
+	bench.mean_run_time = 1000;
+	bench.quantum = 100;
+	bench.seed = 1;
+
+	while ((c = getopt(argc, argv, "n:u:m:q:Q:s:S:W:o:")) != -1)
+	{
+		switch (c)
+		{
+			case 'n': bench.jobs = atoi(optarg); break;
+			case 'u': bench.load = atof(optarg); break;
+			case 'm': bench.mean_run_time = atoi(optarg); break;
+			case 'q': bench.quantum = atoi(optarg); break;
+			case 'S': bench.seed = strtoull(optarg, NULL, 10); break;
+			case 'o': output_name = optarg; break;
+			case 'W': affinity = atoi(optarg); break;
+
+			case 'Q':
+				for (i = PRIQUEUE_LIST; i <= PRIQUEUE_TREE; i++)
+					engines[i] = (strcasecmp(optarg, engine_names[i]) == 0);
+				if (!engines[PRIQUEUE_LIST] && !engines[PRIQUEUE_HEAP] && !engines[PRIQUEUE_TREE])
+				{
+					fprintf(stderr, "Option -Q <engine> requires list, heap or tree.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 's':
+				for (i = 0; i <= LOTTERY; i++)
+					if (strcasecmp(optarg, scheme_names[i]) == 0)
+						only_scheme = i;
+				if (only_scheme == -1)
+				{
+					fprintf(stderr, "Option -s <scheme> requires fcfs, sjf, psjf, pri, ppri, rr, mlfq, edf, cfs, stride or lottery.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			default:
+				print_usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if (bench.jobs <= 0 || bench.load <= 0 || bench.mean_run_time <= 0 || bench.quantum <= 0)
+	{
+		fprintf(stderr, "Options -n, -u, -m and -q need positive values.\n");
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	scheduler_config_init(&bench.config);
+	bench.config.mlfq_quanta[0] = bench.quantum;
+	bench.config.mlfq_quanta[1] = 2 * bench.quantum;
+	bench.config.mlfq_quanta[2] = 4 * bench.quantum;
+	bench.config.cfs_latency = 8 * bench.quantum;
+	bench.config.cfs_granularity = bench.quantum;
+	bench.config.share_quantum = bench.quantum;
+	bench.config.share_seed = bench.seed;
+	bench.config.work_stealing = (affinity >= 0);
+	bench.config.steal_affinity = affinity;
+
+	bench.out = (output_name == NULL) ? stdout : fopen(output_name, "w");
+	if (bench.out == NULL)
+	{
+		fprintf(stderr, "Unable to write file \"%s\".\n", output_name);
+		return 2;
+	}
+
+	// what a latency of nothing reads as
+	double start = now(), overhead;
+	for (i = 0; i < 1000000; i++)
+		now();
+	overhead = (now() - start) * 1e3;
+
+	fprintf(bench.out, "{\n  \"benchmark\": \"scheduler\",\n  \"jobs\": %d,\n  \"load\": %g,\n  \"mean_run_time\": %d,\n  \"quantum\": %d,\n  \"affinity\": %d,\n  \"seed\": %llu,\n  \"timer_ns\": %.1f,\n  \"results\": [",
+			bench.jobs, bench.load, bench.mean_run_time, bench.quantum, affinity, (unsigned long long)bench.seed, overhead);
+
+	for (i = 0; i < (int)(sizeof(core_counts) / sizeof(core_counts[0])); i++)
+	{
+		bench_workload_t workload;
+		generate_workload(&bench, core_counts[i], &workload);
+
+		for (engine = PRIQUEUE_LIST; engine <= PRIQUEUE_TREE; engine++)
+		{
+			if (!engines[engine])
+				continue;
+
+			for (scheme = FCFS; scheme <= LOTTERY; scheme++)
+			{
+				if (only_scheme != -1 && scheme != only_scheme)
+					continue;
+
+				bench_run(&bench, engine, scheme, core_counts[i], &workload);
+				fflush(bench.out);
+			}
+		}
+
+		free_workload(&workload);
+	}
+
+	fprintf(bench.out, "\n  ]\n}\n");
+
+	if (bench.out != stdout && fclose(bench.out) != 0)
+	{
+		fprintf(stderr, "Unable to write file \"%s\".\n", output_name);
+		return 2;
+	}
+
+	return 0;
+}
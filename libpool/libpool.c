@@ -0,0 +1,112 @@
+/** @file libpool.c
+ */
+
+#include <stdlib.h>
+
+#include "libpool.h"
+
+
+//the link to the previous chunk is kept after the chunk's elements
+static void **chunk_link(pool_t *p, void *chunk)
+{
+  return (void **)((char *)chunk + p->size * p->per_chunk);
+}
+
+
+/**
+  Initializes the pool_t data structure.
+
+  No memory is taken until the first pool_alloc().
+
+  @param p a pointer to an instance of the pool_t data structure
+  @param size the size of every element handed out by p
+  @param per_chunk how many elements each malloc'd chunk holds
+ */
+void pool_init(pool_t *p, size_t size, int per_chunk)
+{
+  //round up so every element can hold the freelist link, aligned
+  if(size < sizeof(void *)){
+    size = sizeof(void *);
+  }
+  p->size = (size + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+  p->per_chunk = per_chunk;
+  p->chunks = NULL;
+  p->free = NULL;
+
+  p->stats.heap_calls = 0;
+  p->stats.allocs = 0;
+  p->stats.frees = 0;
+  p->stats.chunks = 0;
+}
+
+
+/**
+  Hands out an element, recycling freed ones before carving a new chunk.
+
+  @param p a pointer to an instance of the pool_t data structure
+  @return an uninitialized element of the pool's size
+  @return NULL if a new chunk was needed and could not be allocated
+ */
+void *pool_alloc(pool_t *p)
+{
+  //freelist is empty, carve a new chunk into it
+  if(p->free == NULL){
+    void *chunk = malloc(p->size * p->per_chunk + sizeof(void *));
+    p->stats.heap_calls++;
+    if(chunk == NULL){
+      return NULL;
+    }
+
+    *chunk_link(p, chunk) = p->chunks;
+    p->chunks = chunk;
+    p->stats.chunks++;
+
+    for(int i = p->per_chunk - 1; i >= 0; i--){
+      void *element = (char *)chunk + p->size * i;
+      *(void **)element = p->free;
+      p->free = element;
+    }
+  }
+
+  void *element = p->free;
+  p->free = *(void **)element;
+  p->stats.allocs++;
+  return element;
+}
+
+
+/**
+  Gives an element back to the pool it came from.
+
+  @param p a pointer to an instance of the pool_t data structure
+  @param ptr an element returned by pool_alloc() on p, or NULL
+ */
+void pool_free(pool_t *p, void *ptr)
+{
+  if(ptr == NULL){
+    return;
+  }
+
+  *(void **)ptr = p->free;
+  p->free = ptr;
+  p->stats.frees++;
+}
+
+
+/**
+  Frees every chunk of the pool at once, including elements still handed out.
+
+  @param p a pointer to an instance of the pool_t data structure
+ */
+void pool_destroy(pool_t *p)
+{
+  while(p->chunks != NULL){
+    void *chunk = p->chunks;
+    p->chunks = *chunk_link(p, chunk);
+    free(chunk);
+    p->stats.heap_calls++;
+  }
+
+  p->free = NULL;
+  p->stats.chunks = 0;
+}
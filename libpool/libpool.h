@@ -0,0 +1,38 @@
+/** @file libpool.h
+ */
+
+#ifndef LIBPOOL_H_
+#define LIBPOOL_H_
+
+#include <stddef.h>
+
+/**
+  Allocation counters of a pool_t
+*/
+typedef struct _pool_stats_t
+{
+  long heap_calls;        //malloc, realloc and free calls made on the owner's behalf
+  long allocs;            //elements handed out
+  long frees;             //elements given back
+  long chunks;            //chunks currently held
+} pool_stats_t;
+
+/**
+  Pool Data Structure, a freelist over fixed size elements carved from chunks
+*/
+typedef struct _pool_t
+{
+  size_t size;            //element size, at least a pointer
+  int per_chunk;
+  void *chunks;           //most recent chunk, each links to the one before
+  void *free;             //first free element, each links to the next
+  pool_stats_t stats;
+} pool_t;
+
+
+void   pool_init    (pool_t *p, size_t size, int per_chunk);
+void * pool_alloc   (pool_t *p);
+void   pool_free    (pool_t *p, void *ptr);
+void   pool_destroy (pool_t *p);
+
+#endif /* LIBPOOL_H_ */
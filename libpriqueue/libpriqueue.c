@@ -3,10 +3,487 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #include "libpriqueue.h"
 
 
+//heap engine helpers
+
+//true if entry a should be served before entry b
+static int heap_before(priqueue_t *q, heap_entry_t *a, heap_entry_t *b)
+{
+  int result = q->comparer(a->value, b->value);
+  if(result == 0){
+    return a->seq < b->seq;
+  }
+  return result < 0;
+}
+
+//the index slot embedded in value, see priqueue_set_slot()
+static int *heap_slot(priqueue_t *q, void *value)
+{
+  return (int *)((char *)value + q->slot);
+}
+
+//stores entry at position i, keeping the element's index slot current
+static void heap_place(priqueue_t *q, heap_entry_t *heap, int i, heap_entry_t entry)
+{
+  heap[i] = entry;
+
+  //only the live heap is tracked, not the snapshot scratch copy
+  if(q->slot >= 0 && heap == q->heap){
+    *heap_slot(q, entry.value) = i;
+  }
+}
+
+//returns the position the entry settled in
+static int heap_sift_up(priqueue_t *q, heap_entry_t *heap, int i)
+{
+  heap_entry_t entry = heap[i];
+
+  while(i > 0){
+    int parent = (i - 1) / 2;
+    if(!heap_before(q, &entry, &heap[parent])){
+      break;
+    }
+    heap_place(q, heap, i, heap[parent]);
+    i = parent;
+  }
+  heap_place(q, heap, i, entry);
+  return i;
+}
+
+static void heap_sift_down(priqueue_t *q, heap_entry_t *heap, int length, int i)
+{
+  heap_entry_t entry = heap[i];
+
+  while(2 * i + 1 < length){
+    int child = 2 * i + 1;
+
+    //pick the higher priority child
+    if(child + 1 < length && heap_before(q, &heap[child + 1], &heap[child])){
+      child++;
+    }
+    if(!heap_before(q, &heap[child], &entry)){
+      break;
+    }
+    heap_place(q, heap, i, heap[child]);
+    i = child;
+  }
+  heap_place(q, heap, i, entry);
+}
+
+//removes the entry stored at heap position i
+static void *heap_delete(priqueue_t *q, int i)
+{
+  void *value = q->heap[i].value;
+
+  q->length--;
+  if(i != q->length){
+    q->heap[i] = q->heap[q->length];
+    heap_sift_down(q, q->heap, q->length, i);
+    heap_sift_up(q, q->heap, i);
+  }
+  if(q->slot >= 0){
+    *heap_slot(q, value) = -1;
+  }
+  q->sorted_valid = 0;
+  return value;
+}
+
+//heap position of ptr if it is queued, -1 otherwise
+static int heap_find(priqueue_t *q, void *ptr)
+{
+  if(q->slot >= 0){
+    int i = *heap_slot(q, ptr);
+    return (i >= 0 && i < q->length && q->heap[i].value == ptr) ? i : -1;
+  }
+
+  for(int i = 0; i < q->length; i++){
+    if(q->heap[i].value == ptr){
+      return i;
+    }
+  }
+  return -1;
+}
+
+//rebuilds the priority ordered snapshot by draining a copy of the heap
+static void heap_sort_snapshot(priqueue_t *q)
+{
+  if(q->sorted_valid){
+    return;
+  }
+
+  heap_entry_t *scratch = q->scratch;
+  int length = q->length;
+
+  for(int i = 0; i < length; i++){
+    scratch[i] = q->heap[i];
+  }
+  for(int i = 0; i < q->length; i++){
+    q->sorted[i] = scratch[0];
+    length--;
+    scratch[0] = scratch[length];
+    heap_sift_down(q, scratch, length, 0);
+  }
+
+  q->sorted_valid = 1;
+}
+
+
+//tree engine helpers, after the red-black tree of Cormen et al. with node 0 as the shared leaf
+
+//true if node a should be served before node b
+static int tree_before(priqueue_t *q, int a, int b)
+{
+  int result = q->comparer(q->tree[a].value, q->tree[b].value);
+  if(result == 0){
+    return q->tree[a].seq < q->tree[b].seq;
+  }
+  return result < 0;
+}
+
+//hands out a node for value, growing the node array when no freed node is left, or -1 if it cannot grow
+static int tree_alloc(priqueue_t *q, void *value)
+{
+  int n = q->tree_free;
+
+  if(n != 0){
+    q->tree_free = q->tree[n].right;
+  }
+  else{
+    if(q->tree_used == q->capacity){
+      int capacity = (q->capacity == 0) ? 16 : q->capacity * 2;
+      tree_node_t *grown = realloc(q->tree, capacity * sizeof(tree_node_t));
+      q->heap_calls++;
+      if(grown == NULL){
+        return -1;
+      }
+      q->tree = grown;
+      q->capacity = capacity;
+    }
+
+    //the first node is the leaf
+    if(q->tree_used == 0){
+      q->tree[0].value = NULL;
+      q->tree[0].left = q->tree[0].right = q->tree[0].parent = 0;
+      q->tree[0].red = 0;
+      q->tree_used = 1;
+    }
+    n = q->tree_used++;
+  }
+
+  q->tree[n].value = value;
+  return n;
+}
+
+static void tree_rotate_left(priqueue_t *q, int x)
+{
+  tree_node_t *t = q->tree;
+  int y = t[x].right;
+
+  t[x].right = t[y].left;
+  if(t[y].left != 0){
+    t[t[y].left].parent = x;
+  }
+  t[y].parent = t[x].parent;
+  if(t[x].parent == 0){
+    q->tree_root = y;
+  }
+  else if(x == t[t[x].parent].left){
+    t[t[x].parent].left = y;
+  }
+  else{
+    t[t[x].parent].right = y;
+  }
+  t[y].left = x;
+  t[x].parent = y;
+}
+
+static void tree_rotate_right(priqueue_t *q, int x)
+{
+  tree_node_t *t = q->tree;
+  int y = t[x].left;
+
+  t[x].left = t[y].right;
+  if(t[y].right != 0){
+    t[t[y].right].parent = x;
+  }
+  t[y].parent = t[x].parent;
+  if(t[x].parent == 0){
+    q->tree_root = y;
+  }
+  else if(x == t[t[x].parent].right){
+    t[t[x].parent].right = y;
+  }
+  else{
+    t[t[x].parent].left = y;
+  }
+  t[y].right = x;
+  t[x].parent = y;
+}
+
+//links node z into the tree behind every node it does not come before
+static void tree_insert(priqueue_t *q, int z)
+{
+  tree_node_t *t = q->tree;
+  int x = q->tree_root, y = 0;
+
+  while(x != 0){
+    y = x;
+    x = tree_before(q, z, x) ? t[x].left : t[x].right;
+  }
+
+  t[z].parent = y;
+  t[z].left = t[z].right = 0;
+  t[z].red = 1;
+  if(y == 0){
+    q->tree_root = z;
+  }
+  else if(tree_before(q, z, y)){
+    t[y].left = z;
+  }
+  else{
+    t[y].right = z;
+  }
+
+  if(q->tree_first == 0 || tree_before(q, z, q->tree_first)){
+    q->tree_first = z;
+  }
+
+  //restore the red-black properties
+  while(t[t[z].parent].red){
+    int p = t[z].parent, g = t[p].parent;
+
+    if(p == t[g].left){
+      int u = t[g].right;
+      if(t[u].red){
+        t[p].red = t[u].red = 0;
+        t[g].red = 1;
+        z = g;
+        continue;
+      }
+      if(z == t[p].right){
+        z = p;
+        tree_rotate_left(q, z);
+        p = t[z].parent;
+      }
+      t[p].red = 0;
+      t[g].red = 1;
+      tree_rotate_right(q, g);
+    }
+    else{
+      int u = t[g].left;
+      if(t[u].red){
+        t[p].red = t[u].red = 0;
+        t[g].red = 1;
+        z = g;
+        continue;
+      }
+      if(z == t[p].left){
+        z = p;
+        tree_rotate_right(q, z);
+        p = t[z].parent;
+      }
+      t[p].red = 0;
+      t[g].red = 1;
+      tree_rotate_left(q, g);
+    }
+  }
+  t[q->tree_root].red = 0;
+}
+
+static int tree_minimum(priqueue_t *q, int x)
+{
+  while(q->tree[x].left != 0){
+    x = q->tree[x].left;
+  }
+  return x;
+}
+
+//the node served after x, 0 if x is the last
+static int tree_successor(priqueue_t *q, int x)
+{
+  tree_node_t *t = q->tree;
+
+  if(t[x].right != 0){
+    return tree_minimum(q, t[x].right);
+  }
+
+  int y = t[x].parent;
+  while(y != 0 && x == t[y].right){
+    x = y;
+    y = t[y].parent;
+  }
+  return y;
+}
+
+//puts v where u was in u's parent, v may be the leaf
+static void tree_transplant(priqueue_t *q, int u, int v)
+{
+  tree_node_t *t = q->tree;
+
+  if(t[u].parent == 0){
+    q->tree_root = v;
+  }
+  else if(u == t[t[u].parent].left){
+    t[t[u].parent].left = v;
+  }
+  else{
+    t[t[u].parent].right = v;
+  }
+  t[v].parent = t[u].parent;
+}
+
+//takes node z out of the tree without freeing it; other nodes keep their positions
+static void tree_unlink(priqueue_t *q, int z)
+{
+  tree_node_t *t = q->tree;
+  int x, y = z, y_red = t[z].red;
+
+  if(q->tree_first == z){
+    q->tree_first = tree_successor(q, z);
+  }
+
+  if(t[z].left == 0){
+    x = t[z].right;
+    tree_transplant(q, z, x);
+  }
+  else if(t[z].right == 0){
+    x = t[z].left;
+    tree_transplant(q, z, x);
+  }
+  else{
+    y = tree_minimum(q, t[z].right);
+    y_red = t[y].red;
+    x = t[y].right;
+
+    if(t[y].parent == z){
+      t[x].parent = y;
+    }
+    else{
+      tree_transplant(q, y, x);
+      t[y].right = t[z].right;
+      t[t[y].right].parent = y;
+    }
+    tree_transplant(q, z, y);
+    t[y].left = t[z].left;
+    t[t[y].left].parent = y;
+    t[y].red = t[z].red;
+  }
+
+  //a black node left its path one black short
+  if(!y_red){
+    while(x != q->tree_root && !t[x].red){
+      int p = t[x].parent;
+
+      if(x == t[p].left){
+        int w = t[p].right;
+        if(t[w].red){
+          t[w].red = 0;
+          t[p].red = 1;
+          tree_rotate_left(q, p);
+          w = t[p].right;
+        }
+        if(!t[t[w].left].red && !t[t[w].right].red){
+          t[w].red = 1;
+          x = p;
+          continue;
+        }
+        if(!t[t[w].right].red){
+          t[t[w].left].red = 0;
+          t[w].red = 1;
+          tree_rotate_right(q, w);
+          w = t[p].right;
+        }
+        t[w].red = t[p].red;
+        t[p].red = 0;
+        t[t[w].right].red = 0;
+        tree_rotate_left(q, p);
+        x = q->tree_root;
+      }
+      else{
+        int w = t[p].left;
+        if(t[w].red){
+          t[w].red = 0;
+          t[p].red = 1;
+          tree_rotate_right(q, p);
+          w = t[p].left;
+        }
+        if(!t[t[w].right].red && !t[t[w].left].red){
+          t[w].red = 1;
+          x = p;
+          continue;
+        }
+        if(!t[t[w].left].red){
+          t[t[w].right].red = 0;
+          t[w].red = 1;
+          tree_rotate_left(q, w);
+          w = t[p].left;
+        }
+        t[w].red = t[p].red;
+        t[p].red = 0;
+        t[t[w].left].red = 0;
+        tree_rotate_right(q, p);
+        x = q->tree_root;
+      }
+    }
+    t[x].red = 0;
+  }
+}
+
+//removes node z and gives it back to the free list
+static void *tree_delete(priqueue_t *q, int z)
+{
+  void *value = q->tree[z].value;
+
+  tree_unlink(q, z);
+  q->tree[z].value = NULL;
+  q->tree[z].right = q->tree_free;
+  q->tree_free = z;
+
+  if(q->slot >= 0){
+    *heap_slot(q, value) = -1;
+  }
+  q->length--;
+  q->sorted_valid = 0;
+  return value;
+}
+
+//node holding ptr, 0 if it is not queued
+static int tree_find(priqueue_t *q, void *ptr)
+{
+  if(q->slot >= 0){
+    int n = *heap_slot(q, ptr);
+    return (n > 0 && n < q->tree_used && q->tree[n].value == ptr) ? n : 0;
+  }
+
+  for(int n = 1; n < q->tree_used; n++){
+    if(q->tree[n].value == ptr){
+      return n;
+    }
+  }
+  return 0;
+}
+
+//node at position index, walking on from the last position asked for when it is not behind it
+static int tree_node_at(priqueue_t *q, int index)
+{
+  if(!q->sorted_valid || q->tree_at > index){
+    q->tree_at = 0;
+    q->tree_at_node = q->tree_first;
+    q->sorted_valid = 1;
+  }
+
+  while(q->tree_at < index){
+    q->tree_at_node = tree_successor(q, q->tree_at_node);
+    q->tree_at++;
+  }
+  return q->tree_at_node;
+}
+
+
 /**
   Initializes the priqueue_t data structure.
 
@@ -18,10 +495,72 @@
   See also @ref comparer-page
  */
 void priqueue_init(priqueue_t *q, comparer_t cmp)
+{
+  priqueue_init_engine(q, cmp, PRIQUEUE_LIST);
+}
+
+
+/**
+  Initializes the priqueue_t data structure with a specific storage engine.
+
+  PRIQUEUE_LIST keeps a sorted linked list (O(n) offer, O(1) poll).
+  PRIQUEUE_HEAP keeps an array backed binary heap (O(log n) offer and poll,
+  priqueue_at sorts a snapshot the first time it is called after a change).
+  PRIQUEUE_TREE keeps an array backed red-black tree (O(log n) offer, poll
+  and remove, O(1) peek at the cached leftmost node, priqueue_at walks on
+  from the position it was last called with).
+  Every engine serves elements that compare equal in the order they were offered.
+
+  @param q a pointer to an instance of the priqueue_t data structure
+  @param cmp a function pointer that compares two elements.
+  @param engine the storage engine backing q
+  See also @ref comparer-page
+ */
+void priqueue_init_engine(priqueue_t *q, comparer_t cmp, priqueue_engine_t engine)
 {
   q->length = 0;
   q->head = NULL;
   q->comparer = cmp;
+  q->engine = engine;
+
+  q->heap = NULL;
+  q->capacity = 0;
+  q->seq = 0;
+  q->sorted = NULL;
+  q->scratch = NULL;
+  q->sorted_valid = 0;
+  q->slot = -1;
+  q->heap_calls = 0;
+
+  q->tree = NULL;
+  q->tree_used = 0;
+  q->tree_free = 0;
+  q->tree_root = 0;
+  q->tree_first = 0;
+  q->tree_at = 0;
+  q->tree_at_node = 0;
+
+  pool_init(&q->nodes, sizeof(node_t), 64);
+}
+
+
+/**
+  Makes q record each element's heap position, or tree node, in an int
+  embedded in the element, so priqueue_remove() and priqueue_update() find
+  it in O(1) instead of scanning. The slot holds -1 while the element is
+  not queued.
+
+  Assumptions:
+    - This function is called right after initializing q and before any offer.
+    - An element is in q at most once, and no other queue shares its slot.
+    - Only PRIQUEUE_HEAP and PRIQUEUE_TREE maintain the slot, PRIQUEUE_LIST ignores it.
+
+  @param q a pointer to an instance of the priqueue_t data structure
+  @param offset offsetof() the int slot inside the elements stored in q
+ */
+void priqueue_set_slot(priqueue_t *q, size_t offset)
+{
+  q->slot = (int)offset;
 }
 
 
@@ -31,12 +570,58 @@ void priqueue_init(priqueue_t *q, comparer_t cmp)
   @param q a pointer to an instance of the priqueue_t data structure
   @param ptr a pointer to the data to be inserted into the priority queue
   @return The zero-based index where ptr is stored in the priority queue, where 0 indicates that ptr was stored at the front of the priority queue.
+  For PRIQUEUE_HEAP the index is the heap position, which is 0 only when ptr is the new head.
+  For PRIQUEUE_TREE it is 0 when ptr is the new head and 1 otherwise.
+  @return -1 if q could not grow, q is then left unchanged
  */
 int priqueue_offer(priqueue_t *q, void *ptr)
 {
+  if(q->engine == PRIQUEUE_TREE){
+    int n = tree_alloc(q, ptr);
+    if(n == -1){
+      return -1;
+    }
+
+    q->tree[n].seq = q->seq++;
+    tree_insert(q, n);
+    if(q->slot >= 0){
+      *heap_slot(q, ptr) = n;
+    }
+    q->length++;
+    q->sorted_valid = 0;
+    return (q->tree_first == n) ? 0 : 1;
+  }
+
+  if(q->engine == PRIQUEUE_HEAP){
+    //grow the heap and snapshot together, the capacity only once all three have grown
+    if(q->length == q->capacity){
+      int capacity = (q->capacity == 0) ? 16 : q->capacity * 2;
+      heap_entry_t **arrays[] = { &q->heap, &q->sorted, &q->scratch };
+
+      for(int a = 0; a < 3; a++){
+        heap_entry_t *grown = realloc(*arrays[a], capacity * sizeof(heap_entry_t));
+        q->heap_calls++;
+        if(grown == NULL){
+          return -1;
+        }
+        *arrays[a] = grown;
+      }
+      q->capacity = capacity;
+    }
+
+    int i = q->length++;
+    q->heap[i].value = ptr;
+    q->heap[i].seq = q->seq++;
+    q->sorted_valid = 0;
+    return heap_sift_up(q, q->heap, i);
+  }
+
   int index = 0;
   // Make new node
-  struct _node_t *new_node = (struct _node_t *) malloc(sizeof(node_t));
+  struct _node_t *new_node = (struct _node_t *) pool_alloc(&q->nodes);
+  if(new_node == NULL){
+    return -1;
+  }
   new_node->value = (void* )ptr;
   new_node->next = NULL;
   struct _node_t *temp_node = q->head;
@@ -100,6 +685,14 @@ int priqueue_offer(priqueue_t *q, void *ptr)
  */
 void *priqueue_peek(priqueue_t *q)
 {
+  if(q->engine == PRIQUEUE_HEAP){
+    return (q->length == 0) ? NULL : q->heap[0].value;
+  }
+
+  if(q->engine == PRIQUEUE_TREE){
+    return (q->length == 0) ? NULL : q->tree[q->tree_first].value;
+  }
+
   //queue is empty
   if(q->head == NULL){
     return NULL;
@@ -119,6 +712,14 @@ void *priqueue_peek(priqueue_t *q)
  */
 void *priqueue_poll(priqueue_t *q)
 {
+  if(q->engine == PRIQUEUE_HEAP){
+    return (q->length == 0) ? NULL : heap_delete(q, 0);
+  }
+
+  if(q->engine == PRIQUEUE_TREE){
+    return (q->length == 0) ? NULL : tree_delete(q, q->tree_first);
+  }
+
   //queue is empty
   if(q->head == NULL){
     return NULL;
@@ -127,9 +728,11 @@ void *priqueue_poll(priqueue_t *q)
   //return the head and remove it from the queue
   else{
     struct _node_t* prev_head = q->head;
+    void *value = prev_head->value;
     q->head = q->head->next;
     q->length = q->length - 1;
-    return prev_head->value;
+    pool_free(&q->nodes, prev_head);
+    return value;
   }
 }
 
@@ -151,6 +754,15 @@ void *priqueue_at(priqueue_t *q, int index)
     return NULL;
   }
 
+  else if(q->engine == PRIQUEUE_HEAP){
+    heap_sort_snapshot(q);
+    return q->sorted[index].value;
+  }
+
+  else if(q->engine == PRIQUEUE_TREE){
+    return q->tree[tree_node_at(q, index)].value;
+  }
+
   else{
     struct _node_t* temp_node = q->head;
     int loops = 0;
@@ -179,36 +791,80 @@ int priqueue_remove(priqueue_t *q, void *ptr)
 {
   int entries = 0;
 
-  //if the head has the value
-  if(q->head->value == ptr){
+  if(q->engine == PRIQUEUE_TREE){
+    int n;
 
-    while(q->head->value == ptr){
-      struct _node_t* temp_node = q->head;
-      q->head = q->head->next;
-      q->length = q->length - 1;
+    //with a slot ptr is queued at most once
+    while((n = tree_find(q, ptr)) != 0){
+      tree_delete(q, n);
       entries++;
-      free(temp_node);
+      if(q->slot >= 0){
+        break;
+      }
     }
+    return entries;
   }
 
-  //else check down the queue
-  else{
+  if(q->engine == PRIQUEUE_HEAP && q->slot >= 0){
+    int i = heap_find(q, ptr);
+    if(i < 0){
+      return 0;
+    }
+    heap_delete(q, i);
+    return 1;
+  }
+
+  if(q->engine == PRIQUEUE_HEAP){
+    int kept = 0;
+
+    //compact the survivors and re-heapify once
+    for(int i = 0; i < q->length; i++){
+      if(q->heap[i].value == ptr){
+        entries++;
+      }
+      else{
+        q->heap[kept++] = q->heap[i];
+      }
+    }
+
+    if(entries > 0){
+      q->length = kept;
+      for(int i = q->length / 2 - 1; i >= 0; i--){
+        heap_sift_down(q, q->heap, q->length, i);
+      }
+      q->sorted_valid = 0;
+    }
+    return entries;
+  }
+
+  //while the head has the value
+  while(q->head != NULL && q->head->value == ptr){
     struct _node_t* temp_node = q->head;
-    struct _node_t* prev_temp = NULL;
+    q->head = q->head->next;
+    q->length = q->length - 1;
+    entries++;
+    pool_free(&q->nodes, temp_node);
+  }
+
+  //then check down the queue
+  if(q->head != NULL){
+    struct _node_t* prev_temp = q->head;
+    struct _node_t* temp_node = q->head->next;
 
     while(temp_node != NULL){
 
       //if the node is equal and not the head
       if(temp_node->value == ptr){
         prev_temp->next = temp_node->next;
-        free(temp_node);
+        pool_free(&q->nodes, temp_node);
         q->length = q->length - 1;
         entries++;
       }
+      else{
+        prev_temp = temp_node;
+      }
 
-      prev_temp = temp_node;
-      temp_node = temp_node->next;
-
+      temp_node = prev_temp->next;
     }
   }
   return entries;
@@ -232,6 +888,23 @@ void *priqueue_remove_at(priqueue_t *q, int index)
       return NULL;
     }
 
+    else if(q->engine == PRIQUEUE_TREE){
+      value = tree_delete(q, tree_node_at(q, index));
+    }
+
+    else if(q->engine == PRIQUEUE_HEAP){
+      heap_sort_snapshot(q);
+      value = q->sorted[index].value;
+
+      //the same pointer may be queued twice, seq tells the copies apart
+      for(int i = 0; i < q->length; i++){
+        if(q->heap[i].seq == q->sorted[index].seq){
+          heap_delete(q, i);
+          break;
+        }
+      }
+    }
+
     else{
       //remove the head
       if(index == 0){
@@ -253,7 +926,7 @@ void *priqueue_remove_at(priqueue_t *q, int index)
         value = temp_node->value;
         prev_node->next = temp_node->next;
         q->length = q->length - 1;
-        free(temp_node);
+        pool_free(&q->nodes, temp_node);
       }
 
     }
@@ -262,6 +935,55 @@ void *priqueue_remove_at(priqueue_t *q, int index)
 
 
 
+/**
+  Repositions ptr after the caller changed the fields its comparer reads.
+
+  Behaves like priqueue_remove() followed by priqueue_offer(), so ptr moves
+  behind any elements that now compare equal to it, but it is done in place
+  in O(log n) when q has an index slot (see priqueue_set_slot()).
+
+  @param q a pointer to an instance of the priqueue_t data structure
+  @param ptr address of the element whose key changed
+  @return 1 if ptr was found and repositioned
+  @return 0 if ptr is not in the queue
+ */
+int priqueue_update(priqueue_t *q, void *ptr)
+{
+  if(q->engine == PRIQUEUE_HEAP){
+    int i = heap_find(q, ptr);
+    if(i < 0){
+      return 0;
+    }
+
+    q->heap[i].seq = q->seq++;
+    heap_sift_down(q, q->heap, q->length, i);
+    heap_sift_up(q, q->heap, i);
+    q->sorted_valid = 0;
+    return 1;
+  }
+
+  if(q->engine == PRIQUEUE_TREE){
+    int n = tree_find(q, ptr);
+    if(n == 0){
+      return 0;
+    }
+
+    //relink the same node, so the slot stays valid
+    tree_unlink(q, n);
+    q->tree[n].seq = q->seq++;
+    tree_insert(q, n);
+    q->sorted_valid = 0;
+    return 1;
+  }
+
+  if(priqueue_remove(q, ptr) == 0){
+    return 0;
+  }
+  priqueue_offer(q, ptr);
+  return 1;
+}
+
+
 /**
   Returns the number of elements in the queue.
 
@@ -274,6 +996,23 @@ int priqueue_size(priqueue_t *q)
 }
 
 
+/**
+  Reports how q has used the heap so far.
+
+  heap_calls covers the list engine's node chunks and the heap and tree
+  engines' arrays; once the queue has reached its largest size it stays
+  constant.
+
+  @param q a pointer to an instance of the priqueue_t data structure
+  @param stats filled in with the counters of q
+ */
+void priqueue_stats(priqueue_t *q, pool_stats_t *stats)
+{
+  *stats = q->nodes.stats;
+  stats->heap_calls += q->heap_calls;
+}
+
+
 /**
   Destroys and frees all the memory associated with q.
 
@@ -281,17 +1020,276 @@ int priqueue_size(priqueue_t *q)
  */
 void priqueue_destroy(priqueue_t *q)
 {
-  //please
-  struct _node_t *temp_node = q->head;
-  struct _node_t *prev_node = NULL;
+  //list nodes go back a chunk at a time
+  pool_destroy(&q->nodes);
+  q->head = NULL;
 
-  while(temp_node!= NULL){
-    temp_node = temp_node->next;
-    prev_node = temp_node;
-    free(prev_node);
-    q->length--;
+  if(q->heap != NULL){
+    free(q->heap);
+    free(q->sorted);
+    free(q->scratch);
+    q->heap_calls += 3;
   }
-  q->head = NULL;
+  if(q->tree != NULL){
+    free(q->tree);
+    q->heap_calls++;
+  }
+  q->heap = NULL;
+  q->sorted = NULL;
+  q->scratch = NULL;
+  q->tree = NULL;
+  q->tree_used = 0;
+  q->tree_free = 0;
+  q->tree_root = 0;
+  q->tree_first = 0;
+  q->capacity = 0;
   q->comparer = NULL;
-  q->length--;
+  q->length = 0;
+}
+
+
+//concurrent MultiQueue helpers
+
+//seeds cpriqueue_state of every thread apart
+static uint64_t cpriqueue_seed;
+
+//xorshift64 state of this thread's part picks, 0 until its first pick
+static __thread uint64_t cpriqueue_state;
+
+//a part of q picked at random
+static int cpriqueue_pick(cpriqueue_t *q)
+{
+  uint64_t x = cpriqueue_state;
+
+  if(x == 0){
+    x = __atomic_add_fetch(&cpriqueue_seed, 0x9e3779b97f4a7c15ULL, __ATOMIC_RELAXED) | 1;
+  }
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  cpriqueue_state = x;
+
+  return (int)(((x >> 32) * (uint64_t)q->count) >> 32);
+}
+
+//polls part, which the caller holds, keeping its length and q's size current
+static void *cpriqueue_take(cpriqueue_t *q, cpriqueue_part_t *part)
+{
+  void *value = priqueue_poll(&part->q);
+
+  __atomic_store_n(&part->length, priqueue_size(&part->q), __ATOMIC_RELEASE);
+  if(value != NULL){
+    __atomic_sub_fetch(&q->size, 1, __ATOMIC_RELEASE);
+  }
+  return value;
+}
+
+
+/**
+  Initializes the cpriqueue_t data structure.
+
+  A cpriqueue_t may be used by any number of threads at once. It holds its
+  elements in parts, each a heap engine priqueue_t behind its own lock;
+  cpriqueue_offer() goes to a random part and cpriqueue_poll() takes the
+  better of the heads of two random parts. Polls are therefore relaxed: the
+  element returned is close to, but not always, the head of the whole
+  queue. With a single part the queue is exact, ties first in first out.
+
+  Assumptions:
+    - You may assume this function will only be called once per instance of cpriqueue_t, before any thread uses it.
+    - About twice as many parts as threads keeps lock contention low.
+
+  @param q a pointer to an instance of the cpriqueue_t data structure
+  @param comparer a function pointer that compares two elements, as for priqueue_init()
+  @param parts the number of sub-queues, at least 1
+ */
+void cpriqueue_init(cpriqueue_t *q, comparer_t comparer, int parts)
+{
+  if(parts < 1){
+    parts = 1;
+  }
+
+  q->parts = aligned_alloc(64, parts * sizeof(cpriqueue_part_t));
+  q->count = parts;
+  q->size = 0;
+
+  for(int i = 0; i < parts; i++){
+    pthread_mutex_init(&q->parts[i].lock, NULL);
+    priqueue_init_engine(&q->parts[i].q, comparer, PRIQUEUE_HEAP);
+    q->parts[i].length = 0;
+  }
+}
+
+
+/**
+  Inserts the specified element into this queue, from any thread.
+
+  A part that another thread holds is passed over for another random one;
+  after as many tries as there are parts, the last one is waited for.
+
+  @param q a pointer to an instance of the cpriqueue_t data structure
+  @param ptr a pointer to the data to be inserted into the queue
+  @return the zero-based index of the part ptr went into
+  @return -1 if that part could not grow, q is then left unchanged
+ */
+int cpriqueue_offer(cpriqueue_t *q, void *ptr)
+{
+  int i = cpriqueue_pick(q);
+
+  for(int tries = 1; pthread_mutex_trylock(&q->parts[i].lock) != 0; tries++){
+    if(tries == q->count){
+      pthread_mutex_lock(&q->parts[i].lock);
+      break;
+    }
+    i = cpriqueue_pick(q);
+  }
+
+  cpriqueue_part_t *part = &q->parts[i];
+  if(priqueue_offer(&part->q, ptr) == -1){
+    pthread_mutex_unlock(&part->lock);
+    return -1;
+  }
+  __atomic_store_n(&part->length, priqueue_size(&part->q), __ATOMIC_RELEASE);
+
+  //counted before the lock is let go, so the size never runs behind a poll
+  __atomic_add_fetch(&q->size, 1, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&part->lock);
+  return i;
+}
+
+
+/**
+  Retrieves, but does not remove, the best head of the parts of this queue.
+
+  Assumptions:
+    - The element is only guaranteed to still be queued, and the comparison
+      to be exact, while no other thread polls the queue.
+
+  @param q a pointer to an instance of the cpriqueue_t data structure
+  @return pointer to the best head of the parts
+  @return NULL if the queue is empty
+ */
+void *cpriqueue_peek(cpriqueue_t *q)
+{
+  void *best = NULL;
+
+  for(int i = 0; i < q->count; i++){
+    cpriqueue_part_t *part = &q->parts[i];
+
+    pthread_mutex_lock(&part->lock);
+    void *head = priqueue_peek(&part->q);
+    if(head != NULL && (best == NULL || part->q.comparer(head, best) < 0)){
+      best = head;
+    }
+    pthread_mutex_unlock(&part->lock);
+  }
+
+  return best;
+}
+
+
+/**
+  Retrieves and removes an element near the head of this queue, from any
+  thread.
+
+  Two parts are picked at random and the better of their heads is taken,
+  both compared under their locks. If the parts keep coming up busy or
+  empty, every part is tried in turn instead, so an element is only missed
+  when the queue is empty or another thread is still inserting it.
+
+  @param q a pointer to an instance of the cpriqueue_t data structure
+  @return an element at or near the head of the queue
+  @return NULL if the queue is empty
+ */
+void *cpriqueue_poll(cpriqueue_t *q)
+{
+  for(int tries = 0; tries < q->count + 4; tries++){
+    if(__atomic_load_n(&q->size, __ATOMIC_ACQUIRE) == 0){
+      return NULL;
+    }
+
+    cpriqueue_part_t *a = &q->parts[cpriqueue_pick(q)];
+    cpriqueue_part_t *b = &q->parts[cpriqueue_pick(q)];
+
+    //an empty pick defers to the other one
+    if(__atomic_load_n(&a->length, __ATOMIC_ACQUIRE) == 0){
+      a = b;
+    }
+    else if(__atomic_load_n(&b->length, __ATOMIC_ACQUIRE) == 0){
+      b = a;
+    }
+
+    if(pthread_mutex_trylock(&a->lock) != 0){
+      continue;
+    }
+    if(b != a && pthread_mutex_trylock(&b->lock) != 0){
+      pthread_mutex_unlock(&a->lock);
+      continue;
+    }
+
+    void *head_a = priqueue_peek(&a->q), *head_b = priqueue_peek(&b->q);
+    cpriqueue_part_t *part = (head_b == NULL || (head_a != NULL && a->q.comparer(head_a, head_b) <= 0)) ? a : b;
+    void *value = cpriqueue_take(q, part);
+
+    if(b != a){
+      pthread_mutex_unlock(&b->lock);
+    }
+    pthread_mutex_unlock(&a->lock);
+
+    if(value != NULL){
+      return value;
+    }
+  }
+
+  //the first part with an element, waiting for each one's lock
+  for(int i = 0; i < q->count; i++){
+    cpriqueue_part_t *part = &q->parts[i];
+    if(__atomic_load_n(&part->length, __ATOMIC_ACQUIRE) == 0){
+      continue;
+    }
+
+    pthread_mutex_lock(&part->lock);
+    void *value = cpriqueue_take(q, part);
+    pthread_mutex_unlock(&part->lock);
+
+    if(value != NULL){
+      return value;
+    }
+  }
+
+  return NULL;
+}
+
+
+/**
+  Returns the number of elements in the queue.
+
+  @param q a pointer to an instance of the cpriqueue_t data structure
+  @return the number of elements in the queue, as of some moment during the call
+ */
+int cpriqueue_size(cpriqueue_t *q)
+{
+  return __atomic_load_n(&q->size, __ATOMIC_ACQUIRE);
+}
+
+
+/**
+  Destroys and frees all the memory associated with q.
+
+  Assumptions:
+    - No other thread uses q any more.
+
+  @param q a pointer to an instance of the cpriqueue_t data structure
+ */
+void cpriqueue_destroy(cpriqueue_t *q)
+{
+  for(int i = 0; i < q->count; i++){
+    priqueue_destroy(&q->parts[i].q);
+    pthread_mutex_destroy(&q->parts[i].lock);
+  }
+
+  free(q->parts);
+  q->parts = NULL;
+  q->count = 0;
+  q->size = 0;
 }
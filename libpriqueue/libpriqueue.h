@@ -4,6 +4,11 @@
 #ifndef LIBPRIQUEUE_H_
 #define LIBPRIQUEUE_H_
 
+#include <stddef.h>
+#include <pthread.h>
+
+#include "../libpool/libpool.h"
+
 // Node structure
 typedef struct _node_t
 {
@@ -11,8 +16,29 @@ typedef struct _node_t
   struct _node_t *next;
 } node_t;
 
+// Heap entry structure
+typedef struct _heap_entry_t
+{
+  void *value;
+  unsigned long seq;      //insertion order, breaks comparer ties FIFO
+} heap_entry_t;
+
+// Red-black tree node structure, linked by position in priqueue_t::tree
+typedef struct _tree_node_t
+{
+  void *value;            //NULL while the node is free
+  unsigned long seq;      //insertion order, breaks comparer ties FIFO
+  int left, right, parent;  //0 is the black leaf shared by every node
+  int red;
+} tree_node_t;
+
 typedef int(*comparer_t)(const void *, const void *);
 
+/**
+  Storage engines a priqueue_t can be initialized with
+*/
+typedef enum {PRIQUEUE_LIST = 0, PRIQUEUE_HEAP, PRIQUEUE_TREE} priqueue_engine_t;
+
 /**
   Priqueue Data Structure
 */
@@ -21,18 +47,69 @@ typedef struct _priqueue_t
   int length;
   node_t *head;
   comparer_t comparer;
+  priqueue_engine_t engine;
+  pool_t nodes;           //list engine nodes
+
+  //heap engine
+  heap_entry_t *heap;
+  int capacity;           //heap or tree entries allocated
+  unsigned long seq;
+  heap_entry_t *sorted;   //priority ordered snapshot used by priqueue_at
+  heap_entry_t *scratch;  //working copy drained to build the snapshot
+  int sorted_valid;
+  int slot;               //offset of the element's index slot, -1 if untracked
+  long heap_calls;        //realloc and free calls for the heap and tree arrays
+
+  //tree engine
+  tree_node_t *tree;      //[0] is the leaf, free nodes link through right
+  int tree_used;          //nodes ever handed out, the leaf included
+  int tree_free;          //first free node, 0 if none
+  int tree_root;
+  int tree_first;         //leftmost node, the head of the queue
+  int tree_at, tree_at_node;  //last position priqueue_at() walked to, valid with sorted_valid
 } priqueue_t;
 
+/**
+  One sub-queue of a cpriqueue_t, on a cache line of its own
+*/
+typedef struct _cpriqueue_part_t
+{
+  pthread_mutex_t lock;
+  priqueue_t q;           //heap engine, used under lock
+  int length;             //size of q, read without the lock to skip empty parts
+} __attribute__((aligned(64))) cpriqueue_part_t;
+
+/**
+  Thread-safe priority queue: a MultiQueue of locked sub-queues
+*/
+typedef struct _cpriqueue_t
+{
+  cpriqueue_part_t *parts;
+  int count;
+  int size;               //summed over the parts, updated atomically
+} cpriqueue_t;
+
+
+void   priqueue_init       (priqueue_t *q, comparer_t cmp);
+void   priqueue_init_engine(priqueue_t *q, comparer_t cmp, priqueue_engine_t engine);
+void   priqueue_set_slot   (priqueue_t *q, size_t offset);
+int    priqueue_offer      (priqueue_t *q, void *ptr);
+void * priqueue_peek       (priqueue_t *q);
+void * priqueue_poll       (priqueue_t *q);
+void * priqueue_at         (priqueue_t *q, int index);
+int    priqueue_remove     (priqueue_t *q, void *ptr);
+void * priqueue_remove_at  (priqueue_t *q, int index);
+int    priqueue_update     (priqueue_t *q, void *ptr);
+int    priqueue_size       (priqueue_t *q);
+void   priqueue_stats      (priqueue_t *q, pool_stats_t *stats);
 
-void   priqueue_init     (priqueue_t *q, comparer_t cmp);
-int    priqueue_offer    (priqueue_t *q, void *ptr);
-void * priqueue_peek     (priqueue_t *q);
-void * priqueue_poll     (priqueue_t *q);
-void * priqueue_at       (priqueue_t *q, int index);
-int    priqueue_remove   (priqueue_t *q, void *ptr);
-void * priqueue_remove_at(priqueue_t *q, int index);
-int    priqueue_size     (priqueue_t *q);
+void   priqueue_destroy    (priqueue_t *q);
 
-void   priqueue_destroy  (priqueue_t *q);
+void   cpriqueue_init      (cpriqueue_t *q, comparer_t cmp, int parts);
+int    cpriqueue_offer     (cpriqueue_t *q, void *ptr);
+void * cpriqueue_peek      (cpriqueue_t *q);
+void * cpriqueue_poll      (cpriqueue_t *q);
+int    cpriqueue_size      (cpriqueue_t *q);
+void   cpriqueue_destroy   (cpriqueue_t *q);
 
 #endif /* LIBPQUEUE_H_ */
@@ -4,11 +4,52 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
+#include <limits.h>
 
 #include "libscheduler.h"
 #include "../libpriqueue/libpriqueue.h"
 
 
+/*
+  Instrumentation, compiled in only with SCHEDULER_STATS defined. Without
+  it every STATS_* macro expands to nothing and scheduler_stats_r()
+  reports enabled == 0.
+*/
+#ifdef SCHEDULER_STATS
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define stats_clock() __rdtsc()
+#else
+#include <time.h>
+//nanoseconds stand in for cycles where there is no time stamp counter
+static uint64_t stats_clock()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+#endif
+
+//comparer calls made by this thread, the compare functions have no scheduler to count into
+static __thread uint64_t stats_comparisons;
+
+#define STATS_COMPARE()     (stats_comparisons++)
+#define STATS_BEGIN()       uint64_t stats_start = stats_clock(), stats_comparisons_start = stats_comparisons
+#define STATS_END(s, call)  stats_record(s, call, stats_clock() - stats_start, stats_comparisons - stats_comparisons_start)
+#define STATS_PREEMPT(s)    ((s)->stats.preemptions++)
+
+#else
+
+#define STATS_COMPARE()
+#define STATS_BEGIN()
+#define STATS_END(s, call)
+#define STATS_PREEMPT(s)
+
+#endif
+
+
 /**
   Stores information making up a job to be scheduled including any statistics.
 
@@ -18,6 +59,7 @@ typedef struct _job_t
 {
   //job characteristics
   int core;                           //core it is on
+  int last_core;                      //core it last ran on, -1 if it has not run yet
   int number;                         //job number
   int priority;                       //job priority
   int arrival_time;                   //time arrived at core
@@ -25,58 +67,144 @@ typedef struct _job_t
   int started;                        //technically bool for if started
   int remaining_time;                 //time left until finished
   int first_call;                     //time it was first put into job queue
+  int deadline;                       //absolute time it should finish by
   int last_ran_time;                   //time it was run last
+  int qslot;                          //position in the job queue heap, or in the lottery
+  int vslot;                          //position in the victim heap
+  int level;                          //MLFQ level, 0 is the top
+  int slice;                          //MLFQ time left of its slice as of arrival_time, else the slice it got on its core
+  int boosts;                         //MLFQ boosts seen, older than the scheduler's means it was boosted
+  struct _job_t *next;                //next job waiting on its MLFQ level
+  int64_t vruntime;                   //CFS virtual runtime or stride pass, in 1/VRUNTIME_SCALE time units at weight NICE_0_WEIGHT
+  int weight;                         //CFS weight or lottery and stride tickets, from its priority
+  int served;                         //time units it has run, as of arrival_time
+  double share_start;                 //the scheduler's share_clock when it arrived
+  double lag;                         //largest distance from its ideal share seen so far
 
   //time statistics
   int waiting_time, turnaround_time, response_time;
 
 } job_t;
 
+//log-linear histogram of a sketch_t: exact below 2 * SKETCH_SUB, then SKETCH_SUB buckets per power of two
+#define SKETCH_SUB_BITS 5
+#define SKETCH_SUB (1 << SKETCH_SUB_BITS)
+#define SKETCH_BUCKETS ((32 - SKETCH_SUB_BITS) * SKETCH_SUB)
+
+/**
+  FIFO of the jobs waiting on one MLFQ level, linked through job_t::next.
+*/
+typedef struct _level_t
+{
+  job_t *head, *tail;
+} level_t;
+
+/**
+  Bounded-memory distribution of one non-negative per-job time.
+*/
+typedef struct _sketch_t
+{
+  uint64_t count;
+  int64_t total;
+  int max;
+  uint64_t *buckets;                  //SKETCH_BUCKETS counters, allocated with the first value
+} sketch_t;
+
 /**
   Stores information making up a job to be scheduled including any statistics.
 
   You may need to define some global variables or a struct to store your job queue elements.
 */
-typedef struct _scheduler_t
+struct _scheduler_t
 {
   int cores;
-  int* idle;
+  job_t **running;                    //job on each core, NULL if idle
   scheme_t scheme;
-  priqueue_t q;
+  priqueue_t q;                       //jobs waiting for a core
+  priqueue_t *run_queues;             //with work stealing, jobs waiting for each core instead, NULL otherwise
+  int affinity;                       //jobs a run queue keeps from thieves
+  uint64_t migrations, steals, stolen;
+  priqueue_t victims;                 //running jobs, next to preempt first (PSJF, PPRI, MLFQ, EDF)
+  priqueue_t idle;                    //idle core ids, lowest first
+  int *core_ids;                      //storage the idle queue points into
+  pool_t job_pool;                    //recycled job_t storage
   int jobs;
 
-  //running totals of time
-  int waiting, turnaround, response;
-
-} scheduler_t;
+  //MLFQ ready queues, top level first, and a bit for every level with jobs waiting
+  level_t *levels;
+  int *quanta;
+  int level_count;
+  unsigned int nonempty;
+  int boost_period, next_boost, boosts;
+
+  //deadlines of jobs that come without one are arrival + deadline_factor * running time
+  double deadline_factor;
+  uint64_t misses;
+  int64_t lateness;                   //summed over finished jobs
+  int max_lateness;
+  sketch_t tardiness;
+
+  //CFS period shared out by weight, smallest slice, and the floor new jobs start their vruntime or pass at
+  int cfs_latency, cfs_granularity;
+  int64_t min_vruntime;
+  int64_t load;                       //summed weight of the jobs running or waiting
+  int live;                           //jobs running or waiting
+
+  //stride and lottery quantum, and the lottery: a Fenwick tree of the tickets of every waiting job
+  int share_quantum;
+  uint64_t random;
+  int64_t *tickets;                   //ticket_capacity + 1 partial sums, 1-based
+  job_t **ticket_jobs;                //job holding each index, 1-based
+  int *ticket_free;                   //stack of unused indexes
+  int ticket_capacity, ticket_free_count;
+  int64_t ticket_total;
+
+  //ideal service per unit of weight, had the busy cores been shared out exactly by weight since time 0
+  double share_clock;
+  int share_time;
+  double max_lag, lag_total;          //over finished jobs, of each one's largest lag
+  int max_lag_job;
+
+  //times of finished jobs, [0] over every job and [1 + class] per priority class
+  sketch_t sketches[1 + SCHEDULER_PRIORITY_CLASSES][SCHEDULER_METRICS];
+
+#ifdef SCHEDULER_STATS
+  scheduler_stats_t stats;
+#endif
+};
 
 //scheme compares
 
 //compare for First Come First Serve changed from arrival time to first call
 int fcfs_compare(const void * a, const void * b)
 {
+  STATS_COMPARE();
 	return ( ((job_t*)a)->first_call - ((job_t*)b)->first_call );
 }
 
 //compare for Shortest Job First
 int sjf_compare(const void * a, const void * b)
 {
+  STATS_COMPARE();
 	return ( ((job_t*)a)->running_time - ((job_t*)b)->running_time );
 }
 
 //compare for Pre-emptive Shortest Job First
 int psjf_compare(const void * a, const void * b)
 {
+  STATS_COMPARE();
 	return ( ((job_t*)a)->remaining_time - ((job_t*)b)->remaining_time );
 }
 
 int pri_compare(const void * a, const void * b)
 {
+  STATS_COMPARE();
 	return ( ((job_t*)a)->priority - ((job_t*)b)->priority );
 }
 
 int ppri_compare(const void * a, const void * b)
 {
+  STATS_COMPARE();
   if( ( ((job_t*)a)->priority - ((job_t*)b)->priority ) == 0){
 	  return ( ((job_t*)a)->first_call - ((job_t*)b)->first_call );
   }
@@ -87,389 +215,1535 @@ int ppri_compare(const void * a, const void * b)
 
 int rr_compare(const void *a, const void * b)
 {
+  STATS_COMPARE();
   return ( ((job_t*)a)->last_ran_time - ((job_t*)b)->last_ran_time );
 }
 
-
-//global scheduler variable
-scheduler_t *s;
-
-/**
-  Initalizes the scheduler.
-
-  Assumptions:
-    - You may assume this will be the first scheduler function called.
-    - You may assume this function will be called once once.
-    - You may assume that cores is a positive, non-zero number.
-    - You may assume that scheme is a valid scheduling scheme.
-
-  @param cores the number of cores that is available by the scheduler. These cores will be known as core(id=0), core(id=1), ..., core(id=cores-1).
-  @param scheme  the scheduling scheme that should be used. This value will be one of the six enum values of scheme_t
-*/
-void scheduler_start_up(int cores, scheme_t scheme)
+//compare for Earliest Deadline First, equal deadlines first come first serve
+int edf_compare(const void * a, const void * b)
 {
-    s = malloc(sizeof(scheduler_t));
-    //initialize number of cores in scheduler
-    s->cores = cores;
-    //Tell the scheduler which shceme we are using
-    s->scheme = scheme;
-
-    //initialize jobs
-    s->jobs = 0;
+  const job_t *x = (const job_t*)a, *y = (const job_t*)b;
+  STATS_COMPARE();
 
-    //initize idle core array
-    s->idle = malloc(cores * sizeof(int));
-    for(int i = 0; i < cores; i++){
-      s->idle[i] = 1;
-    }
+  if(x->deadline != y->deadline){
+    return (x->deadline < y->deadline) ? -1 : 1;
+  }
+  return x->first_call - y->first_call;
+}
 
-    //set times to 0
-    s->waiting = 0;
-    s->turnaround = 0;
-    s->response = 0;
+//compare for the Completely Fair Scheduler, least virtual runtime first then first come first serve
+int cfs_compare(const void * a, const void * b)
+{
+  const job_t *x = (const job_t*)a, *y = (const job_t*)b;
+  STATS_COMPARE();
 
-    //initialize the queue based on scheme
-    if(s->scheme == FCFS){
-      priqueue_init( &s->q, fcfs_compare);
-    }
-    else if(s->scheme == SJF){
-      priqueue_init( &s->q, sjf_compare);
-    }
-    else if(s->scheme == PSJF){
-      priqueue_init( &s->q, psjf_compare);
-    }
-    else if(s->scheme == PRI){
-      priqueue_init( &s->q, pri_compare);
-    }
-    else if(s->scheme == PPRI){
-      priqueue_init( &s->q, ppri_compare);
-    }else if(s->scheme == RR){
-      priqueue_init( &s->q, rr_compare);
-    }
+  if(x->vruntime != y->vruntime){
+    return (x->vruntime < y->vruntime) ? -1 : 1;
+  }
+  return x->first_call - y->first_call;
+}
 
+//compare for stride scheduling, lowest pass first then first come first serve
+int stride_compare(const void * a, const void * b)
+{
+  return cfs_compare(a, b);
 }
 
+//victim compare for PSJF, latest projected finish first then most recently started
+int psjf_victim_compare(const void * a, const void * b)
+{
+  const job_t *x = (const job_t*)a, *y = (const job_t*)b;
+  STATS_COMPARE();
 
-/**
-  Called when a new job arrives.
+  //remaining_time is as of arrival_time, so this is when each would finish
+  int x_finish = x->remaining_time + x->arrival_time;
+  int y_finish = y->remaining_time + y->arrival_time;
 
-  If multiple cores are idle, the job should be assigned to the core with the
-  lowest id.
-  If the job arriving should be scheduled to run during the next
-  time cycle, return the zero-based index of the core the job should be
-  scheduled on. If another job is already running on the core specified,
-  this will preempt the currently running job.
-  Assumptions:
-    - You may assume that every job wil have a unique arrival time.
+  if(x_finish != y_finish){
+    return y_finish - x_finish;
+  }
+  if(x->arrival_time != y->arrival_time){
+    return y->arrival_time - x->arrival_time;
+  }
+  return x->first_call - y->first_call;
+}
 
-  @param job_number a globally unique identification number of the job arriving.
-  @param time the current time of the simulator.
-  @param running_time the total number of time units this job will run before it will be finished.
-  @param priority the priority of the job. (The lower the value, the higher the priority.)
-  @return index of core job should be scheduled on
-  @return -1 if no scheduling changes should be made.
+//victim compare for PPRI, the reverse of the queue order
+int ppri_victim_compare(const void * a, const void * b)
+{
+  return ppri_compare(b, a);
+}
 
- */
-int scheduler_new_job(int job_number, int time, int running_time, int priority)
+//victim compare for MLFQ, lowest level first then most recently started
+int mlfq_victim_compare(const void * a, const void * b)
 {
-  //make a new job node with time, running time, priority
-  struct _job_t *new_job = malloc(sizeof(job_t));
-  new_job->number = job_number;
-  new_job->arrival_time = time;
-  new_job->first_call = time;
-  new_job->running_time = running_time;
-  new_job->remaining_time = running_time;
-  new_job->priority = priority;
-  new_job->waiting_time = 0;
-  new_job->turnaround_time = 0;
-  new_job->response_time = 0;
-  new_job->core = -1;
-  new_job->started = 0;
-  new_job->last_ran_time = time;
+  const job_t *x = (const job_t*)a, *y = (const job_t*)b;
+  STATS_COMPARE();
 
-  //sees if there is an idle core
-  for(int i = 0; i < s->cores; i++){
-    if(s->idle[i] == 1){
-      new_job->core = i;
-      s->idle[i] = 0;
-      break;
-    }
+  if(x->level != y->level){
+    return y->level - x->level;
   }
-
-  //starts running immediately if idling core
-  if(new_job->core != -1){
-    new_job->started = 1;
+  if(x->arrival_time != y->arrival_time){
+    return y->arrival_time - x->arrival_time;
   }
+  return x->first_call - y->first_call;
+}
 
-  //else if PSJF
-  else if(s->scheme == PSJF){
-    int index;
-    int remaining = 0;
-
-    //find the longest currently running remaining time
-    for(int i = 0; i < priqueue_size(&s->q); i++){
+//victim compare for EDF, the reverse of the queue order
+int edf_victim_compare(const void * a, const void * b)
+{
+  return edf_compare(b, a);
+}
 
-      //if currently running
-      if(((job_t *)priqueue_at(&s->q, i))->core != -1){
+int core_compare(const void * a, const void * b)
+{
+  STATS_COMPARE();
+  return ( *(int*)a - *(int*)b );
+}
 
-        //if the current time remaning is newest remaining
-        if( (((job_t *)priqueue_at(&s->q, i))->remaining_time -  (time - ((job_t *)priqueue_at(&s->q, i))->arrival_time ) )> remaining){
-          remaining = ((job_t *)priqueue_at(&s->q, i))->remaining_time -  (time - ((job_t *)priqueue_at(&s->q, i))->arrival_time );
-          ((job_t *)priqueue_at(&s->q, i))->remaining_time = remaining;
-          index = i;
-        }
 
-      }
-    }
+#ifdef SCHEDULER_STATS
+//counts one call that took cycles and made comparisons comparer calls
+static void stats_record(scheduler_t *s, scheduler_call_t call, uint64_t cycles, uint64_t comparisons)
+{
+  scheduler_call_stats_t *c = &s->stats.call[call];
+  int bucket = cycles;
 
-    //if new job will finish sooner
-    if( new_job->remaining_time < remaining ){
-      new_job->core = ((job_t *)priqueue_at(&s->q, index))->core;
-      new_job->started = 1;
+  if(cycles >= 4){
+    int e = 63 - __builtin_clzll(cycles);
+    bucket = 4 * (e - 1) + (int)((cycles >> (e - 2)) & 3);
+  }
 
+  c->calls++;
+  c->cycles += cycles;
+  c->comparisons += comparisons;
+  c->histogram[bucket]++;
+}
+#endif
 
-      if(((job_t *)priqueue_at(&s->q, index))->remaining_time == ((job_t *)priqueue_at(&s->q, index))->running_time){
-        ((job_t *)priqueue_at(&s->q, index))->started = 0;
-      }
 
-      //adjust previously running job information
-      ((job_t *)priqueue_at(&s->q, index))->core = -1;
-      ((job_t *)priqueue_at(&s->q, index))->arrival_time = time;
-    }
+//counts value, in its own bucket below 2 * SKETCH_SUB and in one of SKETCH_SUB per power of two above
+static void sketch_add(sketch_t *k, int value)
+{
+  int bucket = value;
 
+  if(value < 0){
+    value = bucket = 0;
+  }
+  else if(value >= SKETCH_SUB){
+    int shift = 31 - __builtin_clz(value) - SKETCH_SUB_BITS;
+    bucket = shift * SKETCH_SUB + (value >> shift);
   }
 
-  //else if PPRI
-  else if(s->scheme == PPRI){
-    int index;
-    int lowest_priority = -1;
-    for(int i = 0; i < priqueue_size(&s->q); i++){
+  if(k->buckets == NULL){
+    k->buckets = calloc(SKETCH_BUCKETS, sizeof(uint64_t));
+  }
+  if(k->buckets != NULL){
+    k->buckets[bucket]++;
+  }
 
-      //if currently running
-      if(((job_t *)priqueue_at(&s->q, i))->core != -1){
+  if(k->count == 0 || value > k->max){
+    k->max = value;
+  }
+  k->count++;
+  k->total += value;
+}
 
-        //if the current time remaning is newest remaining
-        if( ((job_t *)priqueue_at(&s->q, i))->priority > lowest_priority){
-          lowest_priority = ((job_t *)priqueue_at(&s->q, i))->priority;
-          index = i;
-        }
+//the nearest-rank quantile, as the middle of its bucket
+static int sketch_quantile(const sketch_t *k, double quantile)
+{
+  uint64_t rank = (uint64_t)(quantile * k->count + 0.999999), seen = 0;
 
-        else if( ((job_t *)priqueue_at(&s->q, i))->priority == lowest_priority){
-          if( ((job_t *)priqueue_at(&s->q, i))->first_call < ((job_t *)priqueue_at(&s->q, index))->first_call )
-          lowest_priority = ((job_t *)priqueue_at(&s->q, i))->priority;
-          index = i;
-        }
+  if(k->buckets == NULL || rank >= k->count){
+    return k->max;
+  }
+  if(rank == 0){
+    rank = 1;
+  }
 
+  for(int i = 0; i < SKETCH_BUCKETS; i++){
+    seen += k->buckets[i];
+    if(seen >= rank){
+      if(i < 2 * SKETCH_SUB){
+        return i;
       }
 
+      int shift = i / SKETCH_SUB - 1;
+      int low = (i % SKETCH_SUB + SKETCH_SUB) << shift;
+      int middle = low + ((1 << shift) - 1) / 2;
+      return (middle < k->max) ? middle : k->max;
     }
+  }
+  return k->max;
+}
 
-    if( new_job->priority < lowest_priority){
-      new_job->core = ((job_t *)priqueue_at(&s->q, index))->core;
-      new_job->started = 1;
+//the sketches of priority_class, of every job for -1, or NULL if there is no such class
+static sketch_t *class_sketches(scheduler_t *s, int priority_class)
+{
+  if(priority_class < -1 || priority_class >= SCHEDULER_PRIORITY_CLASSES){
+    return NULL;
+  }
+  return s->sketches[1 + priority_class];
+}
 
-      ((job_t *)priqueue_at(&s->q, index))->remaining_time -= time - ((job_t *)priqueue_at(&s->q, index))->arrival_time;
+//the class a job of priority is summarized in
+static int priority_class(int priority)
+{
+  if(priority < 0){
+    return 0;
+  }
+  return (priority < SCHEDULER_PRIORITY_CLASSES) ? priority : SCHEDULER_PRIORITY_CLASSES - 1;
+}
 
-      //technically the job hasn't started
-      if(((job_t *)priqueue_at(&s->q, index))->remaining_time == ((job_t *)priqueue_at(&s->q, index))->running_time){
-        ((job_t *)priqueue_at(&s->q, index))->started = 0;
-      }
 
-      ((job_t *)priqueue_at(&s->q, index))->core = -1;
-      ((job_t *)priqueue_at(&s->q, index))->arrival_time = time;
-    }
-  }
+//scheduler behind the scheduler_start_up() family of functions
+static scheduler_t *default_scheduler = NULL;
+
+//settings of a scheduler nobody configured
+#define CONFIG_DEFAULTS {               \
+  .queue_engine = PRIQUEUE_LIST,        \
+  .mlfq_levels = 3,                     \
+  .mlfq_quanta = { 2, 4, 8 },           \
+  .mlfq_boost_period = 0,               \
+  .deadline_factor = 2.0,               \
+  .cfs_latency = 24,                    \
+  .cfs_granularity = 3,                 \
+  .share_quantum = 2,                   \
+  .share_seed = 1,                      \
+  .work_stealing = 0,                   \
+  .steal_affinity = 0,                  \
+}
 
-  //put in queue
-  priqueue_offer(&s->q, new_job);
+//settings of schedulers made by scheduler_create()
+static const scheduler_config_t builtin_config = CONFIG_DEFAULTS;
 
-  //increment number of jobs
-  s->jobs++;
+//settings of the default scheduler, changed by the setters below and read by scheduler_start_up()
+static scheduler_config_t default_config = CONFIG_DEFAULTS;
 
-  return new_job->core;
-}
+//CFS weight and stride and lottery tickets of nice -20 to 19, each step about 10% of a core's share, as in Linux
+static const int nice_weights[40] = {
+  88761, 71755, 56483, 46273, 36291,
+  29154, 23254, 18705, 14949, 11916,
+   9548,  7620,  6100,  4904,  3906,
+   3121,  2501,  1991,  1586,  1277,
+   1024,   820,   655,   526,   423,
+    335,   272,   215,   172,   137,
+    110,    87,    70,    56,    45,
+     36,    29,    23,    18,    15,
+};
+#define NICE_0_WEIGHT 1024
+#define VRUNTIME_SCALE 1024
 
 
 /**
-  Called when a job has completed execution.
+  Selects the storage engine of the job queue.
 
-  The core_id, job_number and time parameters are provided for convenience. You may be able to calculate the values with your own data structure.
-  If any job should be scheduled to run on the core free'd up by the
-  finished job, return the job_number of the job that should be scheduled to
-  run on core core_id.
+  Assumptions:
+    - This function is called before scheduler_start_up(), the default is PRIQUEUE_LIST.
+    - Other schedulers take theirs from scheduler_config_t::queue_engine.
 
-  @param core_id the zero-based index of the core where the job was located.
-  @param job_number a globally unique identification number of the job.
-  @param time the current time of the simulator.
-  @return job_number of the job that should be scheduled to run on core core_id
-  @return -1 if core should remain idle.
- */
-int scheduler_job_finished(int core_id, int job_number, int time)
+  @param engine the engine passed to priqueue_init_engine() for the job queue
+*/
+void scheduler_queue_engine(priqueue_engine_t engine)
 {
-  int index = -1;
-  job_t* old_job;
+  default_config.queue_engine = engine;
+}
 
-  //find the job in the queue and remove it
-  for(int i = 0; i < priqueue_size(&s->q); i++){
-    if( ((job_t *)priqueue_at(&s->q, i))->core == core_id){
-      old_job = (job_t *)priqueue_remove_at(&s->q, i);
-      break;
-    }
-  }
+/**
+  Configures the levels of MLFQ schedulers.
 
-  //get the time statistics and delete old_job
-  old_job->turnaround_time = time - old_job->first_call;
-  s->waiting += old_job->waiting_time;
-  s->turnaround += old_job->turnaround_time;
-  s->response += old_job->response_time;
-  free(old_job);
-
-  //if there is a job waiting, start it
-  for(int i = 0; i < priqueue_size(&s->q); i++){
-    if(((job_t *)priqueue_at(&s->q, i))->core == -1){
-      old_job = (job_t *)priqueue_remove_at(&s->q, i);
-      old_job->core = core_id;
-      old_job->waiting_time += (time - old_job->arrival_time);
-
-      if(old_job->started == 0){
-        old_job->response_time = (time - old_job->first_call );
-        old_job->started = 1;
-      }
+  A job arrives on level 0 with the quantum of that level, and moves one
+  level down, with that level's quantum, every time its quantum expires.
+  Every boost_period time units every job is moved back to level 0.
 
-      old_job->arrival_time = time;
-      index = old_job->number;
-      priqueue_offer(&s->q, old_job);
-      return index;
-    }
-  }
+  Assumptions:
+    - This function is called before scheduler_start_up(), the default is 3 levels of quanta 2, 4 and 8 and no boosts.
+    - Other schedulers take theirs from the mlfq_* fields of scheduler_config_t.
+    - You may assume that every quantum is a positive, non-zero number.
 
-  //otherwise set core to idle
-  s->idle[core_id] = 1;
-  return index;
+  @param levels the number of levels, at most SCHEDULER_MLFQ_LEVELS
+  @param quanta the quantum of each level, top level first
+  @param boost_period time units between priority boosts, 0 for none
+*/
+void scheduler_mlfq(int levels, const int *quanta, int boost_period)
+{
+  if(levels < 1){
+    levels = 1;
+  }
+  if(levels > SCHEDULER_MLFQ_LEVELS){
+    levels = SCHEDULER_MLFQ_LEVELS;
+  }
 
+  default_config.mlfq_levels = levels;
+  memcpy(default_config.mlfq_quanta, quanta, levels * sizeof(int));
+  default_config.mlfq_boost_period = boost_period;
 }
 
-
 /**
-  When the scheme is set to RR, called when the quantum timer has expired
-  on a core.
+  Sets how long jobs that arrive without a deadline are given.
 
-  If any job should be scheduled to run on the core free'd up by
-  the quantum expiration, return the job_number of the job that should be
-  scheduled to run on core core_id.
+  Such a job's deadline is its arrival time plus factor times its running
+  time. Every scheme counts deadline misses; EDF also schedules by them.
 
-  @param core_id the zero-based index of the core where the quantum has expired.
-  @param time the current time of the simulator.
-  @return job_number of the job that should be scheduled on core cord_id
-  @return -1 if core should remain idle
- */
-int scheduler_quantum_expired(int core_id, int time)
+  Assumptions:
+    - This function is called before scheduler_start_up(), the default is 2.
+    - Other schedulers take theirs from scheduler_config_t::deadline_factor.
+
+  @param factor a positive multiple of the running time
+*/
+void scheduler_deadline_factor(double factor)
 {
-  int index = -1;
-  int prev_job_id = -1;
-  job_t* old_job;
+  default_config.deadline_factor = factor;
+}
 
-  //find the job in the queue and remove it
-  for(int i = 0; i < priqueue_size(&s->q); i++){
-    if( ((job_t *)priqueue_at(&s->q, i))->core == core_id){
-      old_job = (job_t *)priqueue_remove_at(&s->q, i);
-      break;
-    }
-  }
+/**
+  Configures CFS schedulers.
 
-  //update previously running job data
-  old_job->last_ran_time = time;
-  old_job->core = -1;
-  old_job->arrival_time = time;
-  prev_job_id = old_job->number;
-  priqueue_offer(&s->q, old_job);
+  Every runnable job gets a slice of latency shared out in proportion to
+  its weight, but never less than min_granularity, and the job with the
+  least weighted virtual runtime runs next. A job's priority is its nice
+  value: 0 weighs 1024, and every step up or down shares about 10% less
+  or more, clamped to -20 and 19.
 
-  //if there is a job waiting, start it
-  for(int i = 0; i < priqueue_size(&s->q); i++){
+  Assumptions:
+    - This function is called before scheduler_start_up(), the default is a latency of 24 and a minimum granularity of 3.
+    - Other schedulers take theirs from the cfs_* fields of scheduler_config_t.
+    - You may assume that both are positive, non-zero numbers.
 
-    //find next job
-    if(((job_t *)priqueue_at(&s->q, i))->core == -1 ) {
-      old_job = (job_t *)priqueue_remove_at(&s->q, i);
-      old_job->core = core_id;
-      old_job->waiting_time += (time - old_job->arrival_time);
+  @param latency time units in which every runnable job should get to run once
+  @param min_granularity the shortest slice a job is given
+*/
+void scheduler_cfs(int latency, int min_granularity)
+{
+  default_config.cfs_latency = latency;
+  default_config.cfs_granularity = min_granularity;
+}
 
-      //set response time if first time in core
-      if(old_job->started == 0){
-        old_job->response_time = (time - old_job->first_call );
-        old_job->started = 1;
-      }
+/**
+  Configures stride and lottery schedulers.
 
-      //put back into queue
-      old_job->arrival_time = time;
-      index = old_job->number;
-      priqueue_offer(&s->q, old_job);
-      return index;
-    }
+  Both give every job tickets by its priority, as CFS weighs it, and run
+  jobs for quantum time units at a time. Stride runs the job with the
+  lowest pass, which advances by the inverse of its tickets for the time
+  it ran; lottery draws a ticket at random over every waiting job.
 
-  }
+  Assumptions:
+    - This function is called before scheduler_start_up(), the default is a quantum of 2 and a seed of 1.
+    - Other schedulers take theirs from the share_* fields of scheduler_config_t.
+    - You may assume that quantum is a positive, non-zero number.
 
-	return index;
+  @param quantum time units a job runs before its quantum expires
+  @param seed seed of the lottery draws; the same seed and jobs give the same schedule
+*/
+void scheduler_proportional_share(int quantum, uint64_t seed)
+{
+  default_config.share_quantum = quantum;
+  default_config.share_seed = seed;
 }
 
-
 /**
-  Returns the average waiting time of all jobs scheduled by your scheduler.
+  Gives every core a run queue of its own, balanced by work stealing.
 
-  Assumptions:
-    - This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
-  @return the average waiting time of all jobs scheduled.
- */
-float scheduler_average_waiting_time()
-{
+  A job that arrives while every core is busy waits on the shortest run
+  queue, and a job taken off a core waits on that core's queue again. A
+  core that runs out of jobs steals the head half of the longest queue,
+  provided that queue holds more than affinity jobs; otherwise it idles
+  until a job arrives. MLFQ and LOTTERY keep their single ready structure.
 
-  //divide by number of jobs
+  Assumptions:
+    - This function is called before scheduler_start_up(), the default is a single queue shared by every core.
+    - Other schedulers take theirs from scheduler_config_t::work_stealing and steal_affinity.
 
-	return (float)s->waiting/s->jobs;
+  @param enabled non-zero for one run queue per core
+  @param affinity jobs a queue keeps to its own core, 0 to let idle cores steal from any queue that is not empty
+*/
+void scheduler_work_stealing(int enabled, int affinity)
+{
+  default_config.work_stealing = enabled;
+  default_config.steal_affinity = affinity;
 }
 
-
 /**
-  Returns the average turnaround time of all jobs scheduled by your scheduler.
+  Fills in config with the settings of a scheduler nobody configured.
 
-  Assumptions:
-    - This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
-  @return the average turnaround time of all jobs scheduled.
- */
-float scheduler_average_turnaround_time()
+  @param config the settings to fill in, for scheduler_create_ex()
+*/
+void scheduler_config_init(scheduler_config_t *config)
 {
-
-  //divide running total by jobs
-
-	return (float)s->turnaround/s->jobs;
+  *config = builtin_config;
 }
 
-
 /**
-  Returns the average response time of all jobs scheduled by your scheduler.
+  Creates an independent scheduler instance with the default settings.
+
+  Every scheduler_*_r() function takes the returned handle, so any number of
+  schedulers can run side by side, one per thread if needed.
 
   Assumptions:
-    - This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
-  @return the average response time of all jobs scheduled.
- */
-float scheduler_average_response_time()
-{
-  //divide running total by jobs
+    - You may assume that cores is a positive, non-zero number.
+    - You may assume that scheme is a valid scheduling scheme.
 
-	return (float)s->response/s->jobs;
+  @param cores the number of cores that is available by the scheduler. These cores will be known as core(id=0), core(id=1), ..., core(id=cores-1).
+  @param scheme  the scheduling scheme that should be used. This value will be one of the enum values of scheme_t
+  @return the new scheduler, release it with scheduler_destroy()
+*/
+scheduler_t *scheduler_create(int cores, scheme_t scheme)
+{
+  return scheduler_create_ex(cores, scheme, &builtin_config);
 }
 
-
 /**
-  Free any memory associated with your scheduler.
+  Creates an independent scheduler instance with the given settings.
+
+  The settings are copied, so config may change or go away once this
+  returns, and schedulers can be created from any number of threads at once.
 
   Assumptions:
-    - This function will be the last function called in your library.
+    - You may assume that cores is a positive, non-zero number.
+    - You may assume that scheme is a valid scheduling scheme.
+    - You may assume that every quantum, latency and granularity in config is a positive, non-zero number.
+
+  @param cores the number of cores that is available by the scheduler. These cores will be known as core(id=0), core(id=1), ..., core(id=cores-1).
+  @param scheme  the scheduling scheme that should be used. This value will be one of the enum values of scheme_t
+  @param config the settings of the scheduler, NULL for those of scheduler_config_init()
+  @return the new scheduler, release it with scheduler_destroy()
 */
-void scheduler_clean_up()
+scheduler_t *scheduler_create_ex(int cores, scheme_t scheme, const scheduler_config_t *config)
 {
+    if(config == NULL){
+      config = &builtin_config;
+    }
+    priqueue_engine_t queue_engine = config->queue_engine;
+    int mlfq_levels = config->mlfq_levels;
+    if(mlfq_levels < 1){
+      mlfq_levels = 1;
+    }
+    if(mlfq_levels > SCHEDULER_MLFQ_LEVELS){
+      mlfq_levels = SCHEDULER_MLFQ_LEVELS;
+    }
+
+    scheduler_t *s = malloc(sizeof(scheduler_t));
+    //initialize number of cores in scheduler
+    s->cores = cores;
+    //Tell the scheduler which shceme we are using
+    s->scheme = scheme;
+
+    //initialize jobs
+    s->jobs = 0;
+    pool_init(&s->job_pool, sizeof(job_t), 256);
+
+    //initize running table, every core starts idle
+    s->running = malloc(cores * sizeof(job_t *));
+    s->core_ids = malloc(cores * sizeof(int));
+    priqueue_init_engine( &s->idle, core_compare, PRIQUEUE_HEAP);
+    for(int i = 0; i < cores; i++){
+      s->running[i] = NULL;
+      s->core_ids[i] = i;
+      priqueue_offer( &s->idle, &s->core_ids[i]);
+    }
+
+    //no finished jobs yet
+    memset(s->sketches, 0, sizeof(s->sketches));
+    memset(&s->tardiness, 0, sizeof(s->tardiness));
+    s->deadline_factor = config->deadline_factor;
+    s->misses = 0;
+    s->lateness = 0;
+    s->max_lateness = 0;
+
+    //initialize the queue based on scheme
+    if(s->scheme == FCFS){
+      priqueue_init_engine( &s->q, fcfs_compare, queue_engine);
+    }
+    else if(s->scheme == SJF){
+      priqueue_init_engine( &s->q, sjf_compare, queue_engine);
+    }
+    else if(s->scheme == PSJF){
+      priqueue_init_engine( &s->q, psjf_compare, queue_engine);
+    }
+    else if(s->scheme == PRI){
+      priqueue_init_engine( &s->q, pri_compare, queue_engine);
+    }
+    else if(s->scheme == PPRI){
+      priqueue_init_engine( &s->q, ppri_compare, queue_engine);
+    }else if(s->scheme == RR){
+      priqueue_init_engine( &s->q, rr_compare, queue_engine);
+    }
+    else if(s->scheme == EDF){
+      //always a heap, so dispatch stays O(log n) whatever the engine
+      priqueue_init_engine( &s->q, edf_compare, PRIQUEUE_HEAP);
+    }
+    else if(s->scheme == CFS){
+      //always a tree, which keeps the leftmost job at hand
+      priqueue_init_engine( &s->q, cfs_compare, PRIQUEUE_TREE);
+    }
+    else if(s->scheme == STRIDE){
+      //always a heap, so dispatch stays O(log n) whatever the engine
+      priqueue_init_engine( &s->q, stride_compare, PRIQUEUE_HEAP);
+    }
+    else{
+      //MLFQ waits on its levels and LOTTERY in its tickets, the queue stays empty
+      priqueue_init_engine( &s->q, fcfs_compare, queue_engine);
+    }
+    priqueue_set_slot( &s->q, offsetof(job_t, qslot));
+
+    //per-core run queues order and store their jobs as the shared queue would
+    s->run_queues = NULL;
+    s->affinity = (config->steal_affinity > 0) ? config->steal_affinity : 0;
+    s->migrations = 0;
+    s->steals = 0;
+    s->stolen = 0;
+    if(config->work_stealing && s->scheme != MLFQ && s->scheme != LOTTERY){
+      s->run_queues = malloc(cores * sizeof(priqueue_t));
+      for(int i = 0; i < cores; i++){
+        priqueue_init_engine( &s->run_queues[i], s->q.comparer, s->q.engine);
+        priqueue_set_slot( &s->run_queues[i], offsetof(job_t, qslot));
+      }
+    }
+
+    //MLFQ levels, copied so later changes to config leave this scheduler alone
+    s->level_count = 0;
+    s->levels = NULL;
+    s->quanta = NULL;
+    s->nonempty = 0;
+    s->boost_period = 0;
+    s->next_boost = 0;
+    s->boosts = 0;
+    s->cfs_latency = config->cfs_latency;
+    s->cfs_granularity = config->cfs_granularity;
+    s->min_vruntime = 0;
+    s->load = 0;
+    s->live = 0;
+
+    //the lottery grows with its first job
+    s->share_quantum = config->share_quantum;
+    s->random = config->share_seed;
+    s->tickets = NULL;
+    s->ticket_jobs = NULL;
+    s->ticket_free = NULL;
+    s->ticket_capacity = 0;
+    s->ticket_free_count = 0;
+    s->ticket_total = 0;
+
+    s->share_clock = 0;
+    s->share_time = 0;
+    s->max_lag = 0;
+    s->lag_total = 0;
+    s->max_lag_job = -1;
+    if(s->scheme == MLFQ){
+      s->level_count = mlfq_levels;
+      s->levels = calloc(mlfq_levels, sizeof(level_t));
+      s->quanta = malloc(mlfq_levels * sizeof(int));
+      //a level without a quantum gets twice the quantum of the level above, the top level 2
+      for(int l = 0; l < mlfq_levels; l++){
+        if(config->mlfq_quanta[l] > 0){
+          s->quanta[l] = config->mlfq_quanta[l];
+        }
+        else{
+          s->quanta[l] = (l == 0) ? 2 : 2 * s->quanta[l - 1];
+        }
+      }
+      s->boost_period = (config->mlfq_boost_period > 0) ? config->mlfq_boost_period : 0;
+      s->next_boost = s->boost_period;
+    }
+
+    //preemptive schemes keep their running jobs ordered too
+    if(s->scheme == PSJF){
+      priqueue_init_engine( &s->victims, psjf_victim_compare, PRIQUEUE_HEAP);
+    }
+    else if(s->scheme == MLFQ){
+      priqueue_init_engine( &s->victims, mlfq_victim_compare, PRIQUEUE_HEAP);
+    }
+    else if(s->scheme == EDF){
+      priqueue_init_engine( &s->victims, edf_victim_compare, PRIQUEUE_HEAP);
+    }
+    else{
+      priqueue_init_engine( &s->victims, ppri_victim_compare, PRIQUEUE_HEAP);
+    }
+    priqueue_set_slot( &s->victims, offsetof(job_t, vslot));
+
+#ifdef SCHEDULER_STATS
+    memset(&s->stats, 0, sizeof(s->stats));
+    s->stats.enabled = 1;
+    s->stats.scheme = scheme;
+#endif
+
+    return s;
+}
+
+
+//true if the scheme preempts on arrival and so maintains s->victims
+static int preemptive(scheduler_t *s)
+{
+  return s->scheme == PSJF || s->scheme == PPRI || s->scheme == MLFQ || s->scheme == EDF;
+}
+
+//appends job to the FIFO of its MLFQ level
+static void level_push(scheduler_t *s, job_t *job)
+{
+  level_t *level = &s->levels[job->level];
+
+  job->next = NULL;
+  if(level->tail != NULL){
+    level->tail->next = job;
+  }
+  else{
+    level->head = job;
+  }
+  level->tail = job;
+  s->nonempty |= 1u << job->level;
+}
+
+//takes the first job of the highest non-empty MLFQ level, or NULL
+static job_t *level_pop(scheduler_t *s)
+{
+  if(s->nonempty == 0){
+    return NULL;
+  }
+
+  int l = __builtin_ctz(s->nonempty);
+  level_t *level = &s->levels[l];
+  job_t *job = level->head;
+
+  level->head = job->next;
+  if(level->head == NULL){
+    level->tail = NULL;
+    s->nonempty &= ~(1u << l);
+  }
+
+  //a job that waited through a boost starts over on the top level
+  if(job->boosts != s->boosts){
+    job->level = 0;
+    job->slice = s->quanta[0];
+    job->boosts = s->boosts;
+  }
+  return job;
+}
+
+//next 64 bits of the lottery's splitmix64 stream
+static uint64_t next_random(scheduler_t *s)
+{
+  uint64_t z = (s->random += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+//adds tickets at 1-based index i of the lottery's Fenwick tree
+static void tickets_add(scheduler_t *s, int i, int64_t tickets)
+{
+  for(; i <= s->ticket_capacity; i += i & -i){
+    s->tickets[i] += tickets;
+  }
+  s->ticket_total += tickets;
+}
+
+//doubles the lottery, rebuilding its tree in O(n) from the jobs it holds
+static void lottery_grow(scheduler_t *s)
+{
+  int old = s->ticket_capacity;
+  int capacity = old ? 2 * old : 64;
+
+  s->tickets = realloc(s->tickets, (capacity + 1) * sizeof(int64_t));
+  s->ticket_jobs = realloc(s->ticket_jobs, (capacity + 1) * sizeof(job_t *));
+  s->ticket_free = realloc(s->ticket_free, capacity * sizeof(int));
+
+  //new indexes are handed out lowest first
+  for(int i = capacity; i > old; i--){
+    s->ticket_jobs[i] = NULL;
+    s->ticket_free[s->ticket_free_count++] = i;
+  }
+
+  for(int i = 1; i <= capacity; i++){
+    s->tickets[i] = (s->ticket_jobs[i] != NULL) ? s->ticket_jobs[i]->weight : 0;
+  }
+  for(int i = 1; i <= capacity; i++){
+    int parent = i + (i & -i);
+    if(parent <= capacity){
+      s->tickets[parent] += s->tickets[i];
+    }
+  }
+  s->ticket_capacity = capacity;
+}
+
+//enters a waiting job into the lottery with its tickets
+static void lottery_add(scheduler_t *s, job_t *job)
+{
+  if(s->ticket_free_count == 0){
+    lottery_grow(s);
+  }
+
+  int i = s->ticket_free[--s->ticket_free_count];
+  s->ticket_jobs[i] = job;
+  job->qslot = i;
+  tickets_add(s, i, job->weight);
+}
+
+//draws a ticket and takes its job out of the lottery, or NULL if nobody waits
+static job_t *lottery_draw(scheduler_t *s)
+{
+  if(s->ticket_total == 0){
+    return NULL;
+  }
+
+  //walk down the tree to the index whose prefix sum first passes the winning ticket
+  int64_t ticket = next_random(s) % (uint64_t)s->ticket_total;
+  int i = 0;
+  for(int step = s->ticket_capacity; step > 0; step >>= 1){
+    if(i + step <= s->ticket_capacity && s->tickets[i + step] <= ticket){
+      i += step;
+      ticket -= s->tickets[i];
+    }
+  }
+  i++;
+
+  job_t *job = s->ticket_jobs[i];
+  tickets_add(s, i, -job->weight);
+  s->ticket_jobs[i] = NULL;
+  s->ticket_free[s->ticket_free_count++] = i;
+  job->qslot = -1;
+  return job;
+}
+
+//puts a job that is not running in line for a core
+static void enqueue(scheduler_t *s, job_t *job)
+{
+  if(s->scheme == MLFQ){
+    level_push(s, job);
+  }
+  else if(s->scheme == LOTTERY){
+    lottery_add(s, job);
+  }
+  else if(s->run_queues != NULL){
+    //back to the core it ran on, or to the shortest queue if it has not run
+    int core_id = job->last_core;
+    if(core_id == -1){
+      core_id = 0;
+      for(int i = 1; i < s->cores; i++){
+        if(priqueue_size(&s->run_queues[i]) < priqueue_size(&s->run_queues[core_id])){
+          core_id = i;
+        }
+      }
+    }
+    priqueue_offer(&s->run_queues[core_id], job);
+  }
+  else{
+    priqueue_offer(&s->q, job);
+  }
+}
+
+//moves the head half of the longest run queue to thief's, if that queue holds more than the affinity
+static void steal(scheduler_t *s, int thief)
+{
+  int victim = -1;
+
+  for(int i = 0; i < s->cores; i++){
+    if(i != thief && (victim == -1 || priqueue_size(&s->run_queues[i]) > priqueue_size(&s->run_queues[victim]))){
+      victim = i;
+    }
+  }
+  if(victim == -1 || priqueue_size(&s->run_queues[victim]) <= s->affinity){
+    return;
+  }
+
+  int count = (priqueue_size(&s->run_queues[victim]) + 1) / 2;
+  for(int i = 0; i < count; i++){
+    priqueue_offer(&s->run_queues[thief], priqueue_poll(&s->run_queues[victim]));
+  }
+  s->steals++;
+  s->stolen += count;
+}
+
+//moves every MLFQ job back to the top level if a boost is due by time
+static void boost(scheduler_t *s, int time)
+{
+  if(s->boost_period == 0 || time < s->next_boost){
+    return;
+  }
+
+  //splice every level onto the top one, the jobs are reset as they are polled
+  level_t *top = &s->levels[0];
+  for(int l = 1; l < s->level_count; l++){
+    level_t *level = &s->levels[l];
+    if(level->head == NULL){
+      continue;
+    }
+
+    if(top->tail != NULL){
+      top->tail->next = level->head;
+    }
+    else{
+      top->head = level->head;
+    }
+    top->tail = level->tail;
+    level->head = level->tail = NULL;
+  }
+  s->nonempty = (top->head != NULL) ? 1u : 0u;
+  s->boosts++;
+
+  //running jobs keep their slice, their level is part of the victim key
+  for(int i = 0; i < s->cores; i++){
+    job_t *job = s->running[i];
+    if(job != NULL){
+      priqueue_remove(&s->victims, job);
+      job->level = 0;
+      job->boosts = s->boosts;
+      priqueue_offer(&s->victims, job);
+    }
+  }
+
+  s->next_boost = (time / s->boost_period + 1) * s->boost_period;
+}
+
+//CFS weight and stride and lottery tickets of a job of priority, which is its nice value
+static int priority_weight(int priority)
+{
+  if(priority < -20){
+    priority = -20;
+  }
+  if(priority > 19){
+    priority = 19;
+  }
+  return nice_weights[priority + 20];
+}
+
+//charges a CFS or stride job for running from arrival_time to time, scaled by its weight
+static void charge_vruntime(job_t *job, int time)
+{
+  job->vruntime += (int64_t)(time - job->arrival_time) * VRUNTIME_SCALE * NICE_0_WEIGHT / job->weight;
+}
+
+//advances the share clock to time: the busy cores, at most one per job, shared out by weight
+static void share_advance(scheduler_t *s, int time)
+{
+  if(s->load > 0){
+    int busy = (s->live < s->cores) ? s->live : s->cores;
+    s->share_clock += (double)(time - s->share_time) * busy / s->load;
+  }
+  s->share_time = time;
+}
+
+//records how far job, which has run served time units, is from its ideal share
+static void share_sample(scheduler_t *s, job_t *job)
+{
+  double lag = job->weight * (s->share_clock - job->share_start) - job->served;
+
+  if(lag < 0){
+    lag = -lag;
+  }
+  if(lag > job->lag){
+    job->lag = lag;
+  }
+}
+
+//puts job on core_id, or marks the core idle if job is NULL
+static void run_on(scheduler_t *s, int core_id, job_t *job)
+{
+  s->running[core_id] = job;
+
+  if(job == NULL){
+    priqueue_offer(&s->idle, &s->core_ids[core_id]);
+    return;
+  }
+
+  job->core = core_id;
+  if(job->last_core != -1 && job->last_core != core_id){
+    s->migrations++;
+  }
+  job->last_core = core_id;
+
+  if(s->scheme == CFS){
+    //its share of the latency, the period stretching once the slices would get too short
+    int64_t slice = s->cfs_latency * (int64_t)job->weight / s->load;
+    job->slice = (slice > s->cfs_granularity) ? (int)slice : s->cfs_granularity;
+  }
+  else if(s->scheme == STRIDE || s->scheme == LOTTERY){
+    job->slice = s->share_quantum;
+  }
+
+  if((s->scheme == CFS || s->scheme == STRIDE) && job->vruntime > s->min_vruntime){
+    s->min_vruntime = job->vruntime;
+  }
+  if(preemptive(s)){
+    priqueue_offer(&s->victims, job);
+  }
+}
+
+//takes the running job off core_id without idling the core
+static job_t *take_off(scheduler_t *s, int core_id)
+{
+  job_t *job = s->running[core_id];
+
+  if(job != NULL && preemptive(s)){
+    priqueue_remove(&s->victims, job);
+  }
+  s->running[core_id] = NULL;
+  return job;
+}
+
+
+//starts the head of the queue on core_id, returns its number or -1 if the core goes idle
+static int dispatch(scheduler_t *s, int core_id, int time)
+{
+  job_t *job;
+
+  if(s->scheme == MLFQ){
+    job = level_pop(s);
+  }
+  else if(s->scheme == LOTTERY){
+    job = lottery_draw(s);
+  }
+  else if(s->run_queues != NULL){
+    if(priqueue_size(&s->run_queues[core_id]) == 0){
+      steal(s, core_id);
+    }
+    job = priqueue_poll(&s->run_queues[core_id]);
+  }
+  else{
+    job = priqueue_poll(&s->q);
+  }
+
+  if(job == NULL){
+    run_on(s, core_id, NULL);
+    return -1;
+  }
+
+  job->waiting_time += (time - job->arrival_time);
+
+  //set response time if first time in core
+  if(job->started == 0){
+    job->response_time = (time - job->first_call );
+    job->started = 1;
+  }
+
+  //arrival_time is part of the PSJF victim key, so set it before run_on
+  job->arrival_time = time;
+  share_sample(s, job);
+  run_on(s, core_id, job);
+  return job->number;
+}
+
+
+/**
+  Called when a new job arrives.
+
+  If multiple cores are idle, the job should be assigned to the core with the
+  lowest id.
+  If the job arriving should be scheduled to run during the next
+  time cycle, return the zero-based index of the core the job should be
+  scheduled on. If another job is already running on the core specified,
+  this will preempt the currently running job.
+  Assumptions:
+    - You may assume that every job wil have a unique arrival time.
+
+  @param s the scheduler, as returned by scheduler_create()
+
+  @param job_number a globally unique identification number of the job arriving.
+  @param time the current time of the simulator.
+  @param running_time the total number of time units this job will run before it will be finished.
+  @param priority the priority of the job. (The lower the value, the higher the priority.)
+  @param deadline the absolute time the job should finish by, or -1 for time + factor * running_time, see scheduler_deadline_factor()
+  @return index of core job should be scheduled on
+  @return -1 if no scheduling changes should be made.
+
+ */
+int scheduler_new_job_deadline_r(scheduler_t *s, int job_number, int time, int running_time, int priority, int deadline)
+{
+  STATS_BEGIN();
+  if(s->scheme == MLFQ){
+    boost(s, time);
+  }
+  share_advance(s, time);
+
+  //make a new job node with time, running time, priority
+  struct _job_t *new_job = pool_alloc(&s->job_pool);
+  new_job->number = job_number;
+  new_job->arrival_time = time;
+  new_job->first_call = time;
+  new_job->running_time = running_time;
+  new_job->remaining_time = running_time;
+  new_job->priority = priority;
+  if(deadline == -1){
+    double d = time + s->deadline_factor * running_time;
+    deadline = (d < INT_MAX) ? (int)d : INT_MAX;
+  }
+  new_job->deadline = deadline;
+  new_job->waiting_time = 0;
+  new_job->turnaround_time = 0;
+  new_job->response_time = 0;
+  new_job->core = -1;
+  new_job->last_core = -1;
+  new_job->started = 0;
+  new_job->last_ran_time = time;
+  new_job->qslot = -1;
+  new_job->vslot = -1;
+  new_job->level = 0;
+  new_job->slice = (s->scheme == MLFQ) ? s->quanta[0] : 0;
+  new_job->boosts = s->boosts;
+  new_job->next = NULL;
+  new_job->weight = priority_weight(priority);
+  new_job->vruntime = s->min_vruntime;
+  new_job->served = 0;
+  new_job->share_start = s->share_clock;
+  new_job->lag = 0;
+  s->load += new_job->weight;
+  s->live++;
+
+  job_t *victim = NULL;
+
+  //sees if there is an idle core, lowest id first
+  if(priqueue_size(&s->idle) > 0){
+    new_job->core = *(int *)priqueue_poll(&s->idle);
+    new_job->started = 1;
+  }
+
+  //else if PSJF, preempt the longest remaining time if new job will finish sooner
+  else if(s->scheme == PSJF){
+    victim = (job_t *)priqueue_peek(&s->victims);
+
+    //remaining_time is as of when it was put on the core
+    if( new_job->remaining_time >= victim->remaining_time - (time - victim->arrival_time) ){
+      victim = NULL;
+    }
+  }
+
+  //else if PPRI, preempt the lowest priority if new job is higher
+  else if(s->scheme == PPRI){
+    victim = (job_t *)priqueue_peek(&s->victims);
+
+    if( new_job->priority >= victim->priority){
+      victim = NULL;
+    }
+  }
+
+  //else if MLFQ, preempt the lowest level if it is below the top
+  else if(s->scheme == MLFQ){
+    victim = (job_t *)priqueue_peek(&s->victims);
+
+    if( victim->level == 0){
+      victim = NULL;
+    }
+  }
+
+  //else if EDF, preempt the latest deadline if the new job's is earlier
+  else if(s->scheme == EDF){
+    victim = (job_t *)priqueue_peek(&s->victims);
+
+    if( new_job->deadline >= victim->deadline){
+      victim = NULL;
+    }
+  }
+
+  //adjust previously running job information and queue it
+  if(victim != NULL){
+    STATS_PREEMPT(s);
+    new_job->core = victim->core;
+    new_job->started = 1;
+    take_off(s, victim->core);
+
+    victim->remaining_time -= time - victim->arrival_time;
+    victim->slice -= time - victim->arrival_time;
+    victim->served += time - victim->arrival_time;
+    share_sample(s, victim);
+
+    //technically the job hasn't started
+    if(victim->remaining_time == victim->running_time){
+      victim->started = 0;
+    }
+
+    victim->core = -1;
+    victim->arrival_time = time;
+    enqueue(s, victim);
+  }
+
+  //put on its core, or in queue to wait
+  if(new_job->core != -1){
+    run_on(s, new_job->core, new_job);
+  }
+  else{
+    enqueue(s, new_job);
+  }
+
+  //increment number of jobs
+  s->jobs++;
+
+  STATS_END(s, SCHEDULER_CALL_NEW_JOB);
+  return new_job->core;
+}
+
+
+/**
+  scheduler_new_job_deadline_r() for a job without a deadline of its own.
+
+  @param s the scheduler, as returned by scheduler_create()
+  @param job_number a globally unique identification number of the job arriving.
+  @param time the current time of the simulator.
+  @param running_time the total number of time units this job will run before it will be finished.
+  @param priority the priority of the job. (The lower the value, the higher the priority.)
+  @return index of core job should be scheduled on
+  @return -1 if no scheduling changes should be made.
+ */
+int scheduler_new_job_r(scheduler_t *s, int job_number, int time, int running_time, int priority)
+{
+  return scheduler_new_job_deadline_r(s, job_number, time, running_time, priority, -1);
+}
+
+
+/**
+  Called when a job has completed execution.
+
+  The core_id, job_number and time parameters are provided for convenience. You may be able to calculate the values with your own data structure.
+  If any job should be scheduled to run on the core free'd up by the
+  finished job, return the job_number of the job that should be scheduled to
+  run on core core_id.
+
+  @param s the scheduler, as returned by scheduler_create()
+
+  @param core_id the zero-based index of the core where the job was located.
+  @param job_number a globally unique identification number of the job.
+  @param time the current time of the simulator.
+  @return job_number of the job that should be scheduled to run on core core_id
+  @return -1 if core should remain idle.
+ */
+int scheduler_job_finished_r(scheduler_t *s, int core_id, int job_number, int time)
+{
+  STATS_BEGIN();
+  if(s->scheme == MLFQ){
+    boost(s, time);
+  }
+  share_advance(s, time);
+  job_t* old_job = take_off(s, core_id);
+
+  //its last lag, from before it leaves the share clock
+  old_job->served += time - old_job->arrival_time;
+  share_sample(s, old_job);
+  if(s->max_lag_job == -1 || old_job->lag > s->max_lag){
+    s->max_lag = old_job->lag;
+    s->max_lag_job = old_job->number;
+  }
+  s->lag_total += old_job->lag;
+  s->load -= old_job->weight;
+  s->live--;
+
+  //get the time statistics and delete old_job
+  old_job->turnaround_time = time - old_job->first_call;
+  sketch_t *all = s->sketches[0];
+  sketch_t *class = s->sketches[1 + priority_class(old_job->priority)];
+  sketch_add(&all[SCHEDULER_WAITING], old_job->waiting_time);
+  sketch_add(&all[SCHEDULER_TURNAROUND], old_job->turnaround_time);
+  sketch_add(&all[SCHEDULER_RESPONSE], old_job->response_time);
+  sketch_add(&class[SCHEDULER_WAITING], old_job->waiting_time);
+  sketch_add(&class[SCHEDULER_TURNAROUND], old_job->turnaround_time);
+  sketch_add(&class[SCHEDULER_RESPONSE], old_job->response_time);
+
+  int lateness = time - old_job->deadline;
+  if(lateness > 0){
+    s->misses++;
+  }
+  if(s->tardiness.count == 0 || lateness > s->max_lateness){
+    s->max_lateness = lateness;
+  }
+  s->lateness += lateness;
+  sketch_add(&s->tardiness, (lateness > 0) ? lateness : 0);
+  pool_free(&s->job_pool, old_job);
+
+  //if there is a job waiting start it, otherwise the core goes idle
+  int next_job = dispatch(s, core_id, time);
+
+  STATS_END(s, SCHEDULER_CALL_JOB_FINISHED);
+  return next_job;
+}
+
+
+/**
+  When the scheme is set to RR, MLFQ, CFS, STRIDE or LOTTERY, called when the
+  quantum timer has expired on a core. Under MLFQ the job moves down a level,
+  under CFS and STRIDE it is charged the virtual runtime or pass of its slice.
+
+  If any job should be scheduled to run on the core free'd up by
+  the quantum expiration, return the job_number of the job that should be
+  scheduled to run on core core_id.
+
+  @param s the scheduler, as returned by scheduler_create()
+
+  @param core_id the zero-based index of the core where the quantum has expired.
+  @param time the current time of the simulator.
+  @return job_number of the job that should be scheduled on core cord_id
+  @return -1 if core should remain idle
+ */
+int scheduler_quantum_expired_r(scheduler_t *s, int core_id, int time)
+{
+  STATS_BEGIN();
+  if(s->scheme == MLFQ){
+    boost(s, time);
+  }
+  share_advance(s, time);
+  job_t* old_job = take_off(s, core_id);
+  int next_job = -1;
+
+  //an idle core is already in the idle heap and stays there
+  if(old_job != NULL){
+    //update previously running job data, it queues behind its equals
+    if(s->scheme == CFS || s->scheme == STRIDE){
+      charge_vruntime(old_job, time);
+    }
+    old_job->served += time - old_job->arrival_time;
+    share_sample(s, old_job);
+    old_job->last_ran_time = time;
+    old_job->core = -1;
+    old_job->arrival_time = time;
+    if(s->scheme == MLFQ){
+      if(old_job->level < s->level_count - 1){
+        old_job->level++;
+      }
+      old_job->slice = s->quanta[old_job->level];
+    }
+    enqueue(s, old_job);
+
+    //start the next job, which may be the same one
+    next_job = dispatch(s, core_id, time);
+    if(next_job != old_job->number){
+      STATS_PREEMPT(s);
+    }
+  }
+
+  STATS_END(s, SCHEDULER_CALL_QUANTUM_EXPIRED);
+  return next_job;
+}
+
+
+/**
+  Returns the time slice of the job on a core, for schemes where the
+  scheduler rather than the caller decides it.
+
+  Under MLFQ this is the quantum left to the job at its level, counted
+  from when it was put on the core; under CFS it is the job's share of the
+  latency set with scheduler_cfs(), and under STRIDE and LOTTERY the
+  quantum set with scheduler_proportional_share(). Call it whenever the
+  core gets a new job and run scheduler_quantum_expired_r() once it runs out.
+
+  @param s the scheduler, as returned by scheduler_create()
+  @param core_id the zero-based index of the core
+  @return the time units the job may run before its quantum expires
+  @return 0 if the core is idle or the scheme leaves quanta to the caller, as RR does
+*/
+int scheduler_time_slice_r(scheduler_t *s, int core_id)
+{
+  if(s->scheme == FCFS || s->scheme == SJF || s->scheme == PSJF || s->scheme == PRI ||
+      s->scheme == PPRI || s->scheme == RR || s->scheme == EDF || s->running[core_id] == NULL){
+    return 0;
+  }
+  return s->running[core_id]->slice;
+}
+
+
+/**
+  Returns the average waiting time of all jobs scheduled by your scheduler.
+
+  Assumptions:
+    - This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
+  @param s the scheduler, as returned by scheduler_create()
+  @return the average waiting time of all jobs scheduled.
+ */
+float scheduler_average_waiting_time_r(scheduler_t *s)
+{
+
+  //divide by number of jobs
+
+	return (float)((double)s->sketches[0][SCHEDULER_WAITING].total/s->jobs);
+}
+
+
+/**
+  Returns the average turnaround time of all jobs scheduled by your scheduler.
+
+  Assumptions:
+    - This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
+  @param s the scheduler, as returned by scheduler_create()
+  @return the average turnaround time of all jobs scheduled.
+ */
+float scheduler_average_turnaround_time_r(scheduler_t *s)
+{
+
+  //divide running total by jobs
+
+	return (float)((double)s->sketches[0][SCHEDULER_TURNAROUND].total/s->jobs);
+}
+
+
+/**
+  Returns the average response time of all jobs scheduled by your scheduler.
+
+  Assumptions:
+    - This function will only be called after all scheduling is complete (all jobs that have arrived will have finished and no new jobs will arrive).
+  @param s the scheduler, as returned by scheduler_create()
+  @return the average response time of all jobs scheduled.
+ */
+float scheduler_average_response_time_r(scheduler_t *s)
+{
+  //divide running total by jobs
+
+	return (float)((double)s->sketches[0][SCHEDULER_RESPONSE].total/s->jobs);
+}
+
+
+/**
+  Frees a scheduler and every job it still holds.
+
+  Assumptions:
+    - This function will be the last function called on s.
+
+  @param s the scheduler, as returned by scheduler_create()
+*/
+void scheduler_destroy(scheduler_t *s)
+{
+  //jobs still queued live in the pool, so no walk is needed
+  pool_destroy(&s->job_pool);
+  priqueue_destroy(&s->q);
+  if(s->run_queues != NULL){
+    for(int i = 0; i < s->cores; i++){
+      priqueue_destroy(&s->run_queues[i]);
+    }
+    free(s->run_queues);
+  }
+  priqueue_destroy(&s->victims);
+  priqueue_destroy(&s->idle);
+
+  for(int i = 0; i <= SCHEDULER_PRIORITY_CLASSES; i++){
+    for(int j = 0; j < SCHEDULER_METRICS; j++){
+      free(s->sketches[i][j].buckets);
+    }
+  }
+  free(s->tardiness.buckets);
+
+  free(s->levels);
+  free(s->quanta);
+  free(s->tickets);
+  free(s->ticket_jobs);
+  free(s->ticket_free);
+  free(s->running);
+  free(s->core_ids);
+  free(s);
+}
+
+
+/**
+  Reports how the scheduler has used the heap so far, summed over its job
+  pool and queues. Once every queue has reached its largest size,
+  heap_calls stays constant and scheduling makes no further heap calls.
+
+  @param s the scheduler, as returned by scheduler_create()
+  @param stats filled in with the summed counters
+*/
+void scheduler_pool_stats_r(scheduler_t *s, pool_stats_t *stats)
+{
+  priqueue_t *queues[3] = { &s->q, &s->victims, &s->idle };
+  int count = 3 + ((s->run_queues != NULL) ? s->cores : 0);
+
+  *stats = s->job_pool.stats;
+  for(int i = 0; i < count; i++){
+    pool_stats_t queue_stats;
+    priqueue_stats((i < 3) ? queues[i] : &s->run_queues[i - 3], &queue_stats);
+
+    stats->heap_calls += queue_stats.heap_calls;
+    stats->allocs += queue_stats.allocs;
+    stats->frees += queue_stats.frees;
+    stats->chunks += queue_stats.chunks;
+  }
+}
+
+
+/**
+  Summarizes the waiting, turnaround or response times of the jobs that
+  have finished so far, over all of them or over one priority class.
+
+  Percentiles come from a histogram of fixed size per metric and class,
+  so no per-job history is kept whatever the length of the trace.
+
+  @param s the scheduler, as returned by scheduler_create()
+  @param metric which time to summarize
+  @param priority_class -1 for every job, or 0 to SCHEDULER_PRIORITY_CLASSES - 1
+  @param summary filled in with the count, total, mean, percentiles and maximum
+  @return 1 if at least one job of the class has finished
+  @return 0 otherwise, with summary zeroed
+*/
+int scheduler_summary_r(scheduler_t *s, scheduler_metric_t metric, int priority_class, scheduler_summary_t *summary)
+{
+  sketch_t *sketches = class_sketches(s, priority_class);
+
+  memset(summary, 0, sizeof(*summary));
+  if(sketches == NULL || sketches[metric].count == 0){
+    return 0;
+  }
+
+  sketch_t *k = &sketches[metric];
+  summary->jobs = k->count;
+  summary->total = k->total;
+  summary->mean = (double)k->total / k->count;
+  summary->p50 = sketch_quantile(k, 0.5);
+  summary->p90 = sketch_quantile(k, 0.9);
+  summary->p99 = sketch_quantile(k, 0.99);
+  summary->max = k->max;
+  return 1;
+}
+
+
+/**
+  Estimates any quantile of the waiting, turnaround or response times of
+  the jobs that have finished so far.
+
+  @param s the scheduler, as returned by scheduler_create()
+  @param metric which time to look at
+  @param priority_class -1 for every job, or 0 to SCHEDULER_PRIORITY_CLASSES - 1
+  @param quantile between 0 and 1, e.g. 0.999
+  @return the time, within about 3% and exact below 64
+  @return -1 if no job of the class has finished
+*/
+int scheduler_quantile_r(scheduler_t *s, scheduler_metric_t metric, int priority_class, double quantile)
+{
+  sketch_t *sketches = class_sketches(s, priority_class);
+
+  if(sketches == NULL || sketches[metric].count == 0){
+    return -1;
+  }
+  return sketch_quantile(&sketches[metric], quantile);
+}
+
+
+/**
+  Counts the finished jobs that missed their deadline and summarizes how
+  late or early they finished.
+
+  @param s the scheduler, as returned by scheduler_create()
+  @param stats filled in with the misses, lateness and tardiness percentiles
+  @return 1 if at least one job has finished
+  @return 0 otherwise, with stats zeroed
+*/
+int scheduler_deadlines_r(scheduler_t *s, scheduler_deadline_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+  if(s->tardiness.count == 0){
+    return 0;
+  }
+
+  stats->jobs = s->tardiness.count;
+  stats->misses = s->misses;
+  stats->mean_lateness = (double)s->lateness / s->tardiness.count;
+  stats->max_lateness = s->max_lateness;
+  stats->p50 = sketch_quantile(&s->tardiness, 0.5);
+  stats->p90 = sketch_quantile(&s->tardiness, 0.9);
+  stats->p99 = sketch_quantile(&s->tardiness, 0.99);
+  return 1;
+}
+
+
+/**
+  Reports how far the finished jobs got from their proportional share.
+
+  A job's ideal share at any time is the service it would have had if the
+  busy cores, at most one per job, had been shared out among the jobs
+  present by their weight (their CFS weight or stride and lottery tickets)
+  since it arrived. Its lag is how far its actual service is ahead of or
+  behind that, sampled every time it goes on or off a core.
+
+  @param s the scheduler, as returned by scheduler_create()
+  @param stats filled in with the largest and mean lag over the finished jobs
+  @return 1 if at least one job has finished
+  @return 0 otherwise, with stats zeroed
+*/
+int scheduler_shares_r(scheduler_t *s, scheduler_share_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+  if(s->tardiness.count == 0){
+    return 0;
+  }
+
+  stats->jobs = s->tardiness.count;
+  stats->max_lag = s->max_lag;
+  stats->max_lag_job = s->max_lag_job;
+  stats->mean_lag = s->lag_total / s->tardiness.count;
+  return 1;
+}
+
+
+/**
+  Counts how jobs moved between cores: migrations, where a job resumes on
+  another core than it last ran on, and, with scheduler_work_stealing(),
+  the steals of idle cores and the jobs they took.
+
+  @param s the scheduler, as returned by scheduler_create()
+  @param stats filled in with the counters so far
+*/
+void scheduler_balance_r(scheduler_t *s, scheduler_balance_stats_t *stats)
+{
+  stats->migrations = s->migrations;
+  stats->steals = s->steals;
+  stats->stolen = s->stolen;
+}
+
+
+/**
+  Copies out the instrumentation of the scheduler: per entry point call
+  counts, cycles, latency histograms and queue elements compared, and the
+  number of preemptions.
+
+  Counting costs a time stamp read on entry and exit of every call, so it
+  is only compiled in when SCHEDULER_STATS is defined (make STATS=1).
+  Otherwise stats comes back zeroed with enabled == 0.
+
+  @param s the scheduler, as returned by scheduler_create()
+  @param stats filled in with the counters so far
+*/
+void scheduler_stats_r(scheduler_t *s, scheduler_stats_t *stats)
+{
+#ifdef SCHEDULER_STATS
+  *stats = s->stats;
+#else
+  memset(stats, 0, sizeof(*stats));
+  stats->scheme = s->scheme;
+#endif
+}
+
+
+/**
+  Returns the smallest latency, in cycles, counted in a histogram bucket.
+
+  @param bucket an index into scheduler_call_stats_t::histogram
+  @return the lower bound of the bucket; the bucket ends where bucket + 1 begins
+*/
+uint64_t scheduler_stats_bucket_low(int bucket)
+{
+  if(bucket < 4){
+    return bucket;
+  }
+  return (uint64_t)(4 + bucket % 4) << (bucket / 4 - 1);
+}
+
+
+/**
+  Estimates a latency quantile from the histogram of an entry point.
+
+  @param call the counters of one entry point
+  @param quantile between 0 and 1, e.g. 0.99
+  @return the lower bound, in cycles, of the bucket holding the quantile, which is within 25% of it
+  @return 0 if there were no calls
+*/
+uint64_t scheduler_stats_quantile(const scheduler_call_stats_t *call, double quantile)
+{
+  uint64_t rank = (uint64_t)(quantile * call->calls), seen = 0;
+
+  if(rank >= call->calls){
+    rank = call->calls - 1;
+  }
+
+  for(int i = 0; i < SCHEDULER_STATS_BUCKETS; i++){
+    seen += call->histogram[i];
+    if(seen > rank){
+      return scheduler_stats_bucket_low(i);
+    }
+  }
+  return 0;
+}
 
-}
-
 
 /**
   This function may print out any debugging information you choose. This
@@ -481,11 +1755,188 @@ void scheduler_clean_up()
 
   This function is not required and will not be graded. You may leave it
   blank if you do not find it useful.
- */
-void scheduler_show_queue()
+
+  @param s the scheduler, as returned by scheduler_create()
+*/
+void scheduler_show_queue_r(scheduler_t *s)
 {
+  for(int i = 0; i < s->cores; i++ ){
+    if(s->running[i] != NULL){
+      printf("%d(%d) ", s->running[i]->number, i);
+    }
+  }
   for(int i = 0; i < priqueue_size(&s->q); i++ ){
     printf("%d(%d) ", ((job_t *)priqueue_at(&s->q, i))->number, ((job_t *)priqueue_at(&s->q, i))->core);
   }
+  for(int c = 0; s->run_queues != NULL && c < s->cores; c++ ){
+    for(int i = 0; i < priqueue_size(&s->run_queues[c]); i++ ){
+      printf("%d(%d) ", ((job_t *)priqueue_at(&s->run_queues[c], i))->number, ((job_t *)priqueue_at(&s->run_queues[c], i))->core);
+    }
+  }
+  for(int l = 0; l < s->level_count; l++ ){
+    for(job_t *job = s->levels[l].head; job != NULL; job = job->next){
+      printf("%d(%d) ", job->number, job->core);
+    }
+  }
+  for(int i = 1; i <= s->ticket_capacity; i++ ){
+    if(s->ticket_jobs[i] != NULL){
+      printf("%d(%d) ", s->ticket_jobs[i]->number, s->ticket_jobs[i]->core);
+    }
+  }
   printf("\n");
 }
+
+
+/*
+  The original interface, kept as thin wrappers over one default scheduler.
+*/
+
+/**
+  Initalizes the default scheduler used by the functions without a handle,
+  with the settings given to scheduler_queue_engine() and the other setters.
+
+  Assumptions:
+    - You may assume this will be the first scheduler function called.
+    - You may assume this function will be called once once.
+    - You may assume that cores is a positive, non-zero number.
+    - You may assume that scheme is a valid scheduling scheme.
+
+  @param cores the number of cores that is available by the scheduler. These cores will be known as core(id=0), core(id=1), ..., core(id=cores-1).
+  @param scheme  the scheduling scheme that should be used. This value will be one of the enum values of scheme_t
+*/
+void scheduler_start_up(int cores, scheme_t scheme)
+{
+  default_scheduler = scheduler_create_ex(cores, scheme, &default_config);
+}
+
+/**
+  scheduler_new_job_r() on the default scheduler.
+*/
+int scheduler_new_job(int job_number, int time, int running_time, int priority)
+{
+  return scheduler_new_job_r(default_scheduler, job_number, time, running_time, priority);
+}
+
+/**
+  scheduler_new_job_deadline_r() on the default scheduler.
+*/
+int scheduler_new_job_deadline(int job_number, int time, int running_time, int priority, int deadline)
+{
+  return scheduler_new_job_deadline_r(default_scheduler, job_number, time, running_time, priority, deadline);
+}
+
+/**
+  scheduler_job_finished_r() on the default scheduler.
+*/
+int scheduler_job_finished(int core_id, int job_number, int time)
+{
+  return scheduler_job_finished_r(default_scheduler, core_id, job_number, time);
+}
+
+/**
+  scheduler_quantum_expired_r() on the default scheduler.
+*/
+int scheduler_quantum_expired(int core_id, int time)
+{
+  return scheduler_quantum_expired_r(default_scheduler, core_id, time);
+}
+
+/**
+  scheduler_time_slice_r() on the default scheduler.
+*/
+int scheduler_time_slice(int core_id)
+{
+  return scheduler_time_slice_r(default_scheduler, core_id);
+}
+
+/**
+  scheduler_average_waiting_time_r() on the default scheduler.
+*/
+float scheduler_average_waiting_time()
+{
+  return scheduler_average_waiting_time_r(default_scheduler);
+}
+
+/**
+  scheduler_average_turnaround_time_r() on the default scheduler.
+*/
+float scheduler_average_turnaround_time()
+{
+  return scheduler_average_turnaround_time_r(default_scheduler);
+}
+
+/**
+  scheduler_average_response_time_r() on the default scheduler.
+*/
+float scheduler_average_response_time()
+{
+  return scheduler_average_response_time_r(default_scheduler);
+}
+
+/**
+  Free any memory associated with your scheduler.
+
+  Assumptions:
+    - This function will be the last function called in your library.
+*/
+void scheduler_clean_up()
+{
+  scheduler_destroy(default_scheduler);
+  default_scheduler = NULL;
+}
+
+/**
+  scheduler_pool_stats_r() on the default scheduler.
+*/
+void scheduler_pool_stats(pool_stats_t *stats)
+{
+  scheduler_pool_stats_r(default_scheduler, stats);
+}
+
+/**
+  scheduler_summary_r() on the default scheduler.
+*/
+int scheduler_summary(scheduler_metric_t metric, int priority_class, scheduler_summary_t *summary)
+{
+  return scheduler_summary_r(default_scheduler, metric, priority_class, summary);
+}
+
+/**
+  scheduler_deadlines_r() on the default scheduler.
+*/
+int scheduler_deadlines(scheduler_deadline_stats_t *stats)
+{
+  return scheduler_deadlines_r(default_scheduler, stats);
+}
+
+/**
+  scheduler_shares_r() on the default scheduler.
+*/
+int scheduler_shares(scheduler_share_stats_t *stats)
+{
+  return scheduler_shares_r(default_scheduler, stats);
+}
+
+/**
+  scheduler_balance_r() on the default scheduler.
+*/
+void scheduler_balance(scheduler_balance_stats_t *stats)
+{
+  scheduler_balance_r(default_scheduler, stats);
+}
+
+/**
+  scheduler_stats_r() on the default scheduler.
+*/
+void scheduler_stats(scheduler_stats_t *stats)
+{
+  scheduler_stats_r(default_scheduler, stats);
+}
+
+/**
+  scheduler_show_queue_r() on the default scheduler.
+*/
+void scheduler_show_queue()
+{
+  scheduler_show_queue_r(default_scheduler);
+}
@@ -4,21 +4,187 @@
 #ifndef LIBSCHEDULER_H_
 #define LIBSCHEDULER_H_
 
+#include <stdint.h>
+
+#include "../libpriqueue/libpriqueue.h"
+
 /**
   Constants which represent the different scheduling algorithms
 */
-typedef enum {FCFS = 0, SJF, PSJF, PRI, PPRI, RR} scheme_t;
+typedef enum {FCFS = 0, SJF, PSJF, PRI, PPRI, RR, MLFQ, EDF, CFS, STRIDE, LOTTERY} scheme_t;
+
+/**
+  Most levels an MLFQ scheduler can have, one bit each in its bitmap of
+  non-empty levels
+*/
+#define SCHEDULER_MLFQ_LEVELS 32
+
+/**
+  Opaque scheduler instance, see scheduler_create()
+*/
+typedef struct _scheduler_t scheduler_t;
+
+/**
+  Settings of a scheduler, read once by scheduler_create_ex(); fill one in
+  with scheduler_config_init() and change only what differs
+*/
+typedef struct _scheduler_config_t
+{
+  priqueue_engine_t queue_engine;   //engine of the job queue
+  int mlfq_levels;                  //1 to SCHEDULER_MLFQ_LEVELS
+  int mlfq_quanta[SCHEDULER_MLFQ_LEVELS];  //quantum of each level, top level first, 0 for twice the level above
+  int mlfq_boost_period;            //time units between priority boosts, 0 for none
+  double deadline_factor;           //deadline of jobs that arrive without one, in multiples of their running time
+  int cfs_latency;
+  int cfs_granularity;
+  int share_quantum;                //quantum of stride and lottery
+  uint64_t share_seed;              //seed of the lottery draws
+  int work_stealing;                //non-zero for one run queue per core
+  int steal_affinity;               //jobs a run queue keeps to its own core
+} scheduler_config_t;
+
+/**
+  Per-job times summarized by scheduler_summary()
+*/
+typedef enum {SCHEDULER_WAITING = 0, SCHEDULER_TURNAROUND, SCHEDULER_RESPONSE, SCHEDULER_METRICS} scheduler_metric_t;
+
+/**
+  Jobs are summarized per priority class too: priorities 0 to
+  SCHEDULER_PRIORITY_CLASSES - 1 each have their own, lower priorities
+  count as class 0 and higher ones as the last class
+*/
+#define SCHEDULER_PRIORITY_CLASSES 32
+
+/**
+  Distribution of one per-job time over the finished jobs of a scheduler
+  or of one of its priority classes
+*/
+typedef struct _scheduler_summary_t
+{
+  uint64_t jobs;
+  int64_t total;          //sum over the jobs
+  double mean;
+  int p50, p90, p99;      //within about 3% of the exact percentile, exact below 64
+  int max;
+} scheduler_summary_t;
+
+/**
+  How the finished jobs of a scheduler did against their deadlines
+*/
+typedef struct _scheduler_deadline_stats_t
+{
+  uint64_t jobs;
+  uint64_t misses;        //jobs that finished after their deadline
+  double mean_lateness;   //finish time minus deadline, negative for jobs that finished early
+  int max_lateness;
+  int p50, p90, p99;      //tardiness, the lateness of late jobs and 0 for the others, within about 3%
+} scheduler_deadline_stats_t;
+
+/**
+  How far the finished jobs of a scheduler got from their proportional
+  share, see scheduler_shares_r()
+*/
+typedef struct _scheduler_share_stats_t
+{
+  uint64_t jobs;
+  double max_lag;         //time units ahead of or behind its ideal share, of the job furthest off
+  int max_lag_job;        //number of that job
+  double mean_lag;        //of each job's largest lag
+} scheduler_share_stats_t;
+
+/**
+  How jobs moved between cores, see scheduler_balance_r()
+*/
+typedef struct _scheduler_balance_stats_t
+{
+  uint64_t migrations;    //jobs put on another core than the one they last ran on
+  uint64_t steals;        //times an idle core took jobs from another core's run queue
+  uint64_t stolen;        //jobs taken by those steals
+} scheduler_balance_stats_t;
+
+/**
+  Entry points counted by scheduler_stats(), used as indexes into scheduler_stats_t::call
+*/
+typedef enum {SCHEDULER_CALL_NEW_JOB = 0, SCHEDULER_CALL_JOB_FINISHED, SCHEDULER_CALL_QUANTUM_EXPIRED, SCHEDULER_CALLS} scheduler_call_t;
+
+/**
+  Latency histogram buckets: values below 4 have a bucket each, every
+  power of two above that is split into 4 equal sub-buckets
+*/
+#define SCHEDULER_STATS_BUCKETS 252
 
+/**
+  Counters of one entry point
+*/
+typedef struct _scheduler_call_stats_t
+{
+  uint64_t calls;
+  uint64_t cycles;        //summed over every call
+  uint64_t comparisons;   //comparer calls, summed over every call
+  uint64_t histogram[SCHEDULER_STATS_BUCKETS];  //calls per latency bucket, in cycles
+} scheduler_call_stats_t;
 
+/**
+  Instrumentation of one scheduler, collected only when libscheduler is
+  compiled with SCHEDULER_STATS defined
+*/
+typedef struct _scheduler_stats_t
+{
+  int enabled;            //0 if compiled without SCHEDULER_STATS, everything else is then 0
+  scheme_t scheme;
+  scheduler_call_stats_t call[SCHEDULER_CALLS];
+  uint64_t preemptions;   //running jobs taken off a core before they finished
+} scheduler_stats_t;
+
+
+void  scheduler_queue_engine           (priqueue_engine_t engine);
+void  scheduler_mlfq                   (int levels, const int *quanta, int boost_period);
+void  scheduler_deadline_factor        (double factor);
+void  scheduler_cfs                    (int latency, int min_granularity);
+void  scheduler_proportional_share     (int quantum, uint64_t seed);
+void  scheduler_work_stealing          (int enabled, int affinity);
 void  scheduler_start_up               (int cores, scheme_t scheme);
 int   scheduler_new_job                (int job_number, int time, int running_time, int priority);
+int   scheduler_new_job_deadline       (int job_number, int time, int running_time, int priority, int deadline);
 int   scheduler_job_finished           (int core_id, int job_number, int time);
 int   scheduler_quantum_expired        (int core_id, int time);
+int   scheduler_time_slice             (int core_id);
 float scheduler_average_turnaround_time();
 float scheduler_average_waiting_time   ();
 float scheduler_average_response_time  ();
 void  scheduler_clean_up               ();
+void  scheduler_pool_stats             (pool_stats_t *stats);
+
+void  scheduler_stats                  (scheduler_stats_t *stats);
+int   scheduler_summary                (scheduler_metric_t metric, int priority_class, scheduler_summary_t *summary);
+int   scheduler_deadlines              (scheduler_deadline_stats_t *stats);
+int   scheduler_shares                 (scheduler_share_stats_t *stats);
+void  scheduler_balance                (scheduler_balance_stats_t *stats);
 
 void  scheduler_show_queue             ();
 
+void  scheduler_config_init            (scheduler_config_t *config);
+scheduler_t *scheduler_create          (int cores, scheme_t scheme);
+scheduler_t *scheduler_create_ex       (int cores, scheme_t scheme, const scheduler_config_t *config);
+int   scheduler_new_job_r              (scheduler_t *s, int job_number, int time, int running_time, int priority);
+int   scheduler_new_job_deadline_r     (scheduler_t *s, int job_number, int time, int running_time, int priority, int deadline);
+int   scheduler_job_finished_r         (scheduler_t *s, int core_id, int job_number, int time);
+int   scheduler_quantum_expired_r      (scheduler_t *s, int core_id, int time);
+int   scheduler_time_slice_r           (scheduler_t *s, int core_id);
+float scheduler_average_turnaround_time_r(scheduler_t *s);
+float scheduler_average_waiting_time_r (scheduler_t *s);
+float scheduler_average_response_time_r(scheduler_t *s);
+void  scheduler_pool_stats_r           (scheduler_t *s, pool_stats_t *stats);
+void  scheduler_stats_r                (scheduler_t *s, scheduler_stats_t *stats);
+int   scheduler_summary_r              (scheduler_t *s, scheduler_metric_t metric, int priority_class, scheduler_summary_t *summary);
+int   scheduler_quantile_r             (scheduler_t *s, scheduler_metric_t metric, int priority_class, double quantile);
+int   scheduler_deadlines_r            (scheduler_t *s, scheduler_deadline_stats_t *stats);
+int   scheduler_shares_r               (scheduler_t *s, scheduler_share_stats_t *stats);
+void  scheduler_balance_r              (scheduler_t *s, scheduler_balance_stats_t *stats);
+void  scheduler_show_queue_r           (scheduler_t *s);
+
+uint64_t scheduler_stats_bucket_low    (int bucket);
+uint64_t scheduler_stats_quantile      (const scheduler_call_stats_t *call, double quantile);
+void  scheduler_destroy                (scheduler_t *s);
+
 #endif /* LIBSCHEDULER_H_ */
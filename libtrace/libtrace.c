@@ -0,0 +1,374 @@
+/** @file libtrace.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "libtrace.h"
+
+
+//checks the header of a binary trace against the size of the file
+static int header_valid(const trace_t *trace)
+{
+  const trace_header_t *header = (const trace_header_t *)trace->data;
+
+  //version 1 records have no deadline
+  uint32_t record_size = (header->version == 1) ? offsetof(trace_record_t, deadline) : sizeof(trace_record_t);
+
+  if(header->version < 1 || header->version > TRACE_VERSION || header->byte_order != TRACE_BYTE_ORDER ||
+      header->record_size != record_size){
+    fprintf(stderr, "Unsupported binary trace (version %u).\n", header->version);
+    return 0;
+  }
+
+  if((trace->size - sizeof(trace_header_t)) / record_size < header->job_count){
+    fprintf(stderr, "Binary trace is truncated.\n");
+    return 0;
+  }
+
+  //trace_count_jobs() returns the count as an int
+  if(header->job_count > INT_MAX){
+    fprintf(stderr, "Binary trace has too many jobs.\n");
+    return 0;
+  }
+
+  return 1;
+}
+
+
+/**
+  Maps a trace file read-only.
+
+  The file is either a CSV with a header line and one arrival time,
+  running time, priority and optional absolute deadline per line, or a
+  binary trace as written with trace_write_header() and
+  trace_write_job(). An empty file maps to no data.
+
+  @param trace a pointer to the trace_t to fill in
+  @param file_name the file to map
+  @return 1 on success
+  @return 0 if the file could not be mapped or is an unsupported binary trace
+ */
+int trace_open(trace_t *trace, const char *file_name)
+{
+  struct stat st;
+  int fd = open(file_name, O_RDONLY);
+
+  if(fd < 0){
+    return 0;
+  }
+
+  if(fstat(fd, &st) != 0){
+    close(fd);
+    return 0;
+  }
+
+  trace->data = NULL;
+  trace->size = st.st_size;
+  trace->binary = 0;
+
+  if(trace->size > 0){
+    void *data = mmap(NULL, trace->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data == MAP_FAILED){
+      close(fd);
+      return 0;
+    }
+
+    madvise(data, trace->size, MADV_SEQUENTIAL);
+    trace->data = data;
+  }
+
+  close(fd);
+
+  trace->binary = (trace->size >= sizeof(trace_header_t) && memcmp(trace->data, TRACE_MAGIC, 8) == 0);
+  if(trace->binary && !header_valid(trace)){
+    trace_close(trace);
+    return 0;
+  }
+
+  return 1;
+}
+
+
+/**
+  Unmaps a trace. Cursors over it must not be used afterwards.
+
+  @param trace a pointer to a trace_t opened with trace_open()
+ */
+void trace_close(trace_t *trace)
+{
+  if(trace->data != NULL){
+    munmap((void *)trace->data, trace->size);
+  }
+  trace->data = NULL;
+}
+
+
+//scans a decimal integer at *pos, with blanks around it, and leaves *pos after it
+static int scan_int(const char **pos, const char *end, int *value)
+{
+  const char *p = *pos;
+  int negative = 0;
+  long v = 0;
+
+  while(p < end && (*p == ' ' || *p == '\t')){
+    p++;
+  }
+
+  if(p < end && (*p == '-' || *p == '+')){
+    negative = (*p++ == '-');
+  }
+
+  if(p == end || *p < '0' || *p > '9'){
+    return 0;
+  }
+
+  while(p < end && *p >= '0' && *p <= '9'){
+    v = v * 10 + (*p++ - '0');
+    if(v > INT_MAX){
+      return 0;
+    }
+  }
+
+  while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')){
+    p++;
+  }
+
+  *value = negative ? -v : v;
+  *pos = p;
+  return 1;
+}
+
+
+//parses the next CSV line into job, skipping blank lines; returns 0 at the end or on error
+static int next_csv_job(trace_cursor_t *cursor, trace_job_t *job)
+{
+  while(cursor->pos < cursor->end){
+    const char *p = cursor->pos;
+    const char *eol = memchr(p, '\n', cursor->end - p);
+
+    if(eol == NULL){
+      eol = cursor->end;
+    }
+    cursor->pos = (eol < cursor->end) ? eol + 1 : eol;
+    cursor->line++;
+
+    //blank line
+    while(p < eol && (*p == ' ' || *p == '\t' || *p == '\r')){
+      p++;
+    }
+    if(p == eol){
+      continue;
+    }
+
+    if(!scan_int(&p, eol, &job->arrival_time) || p == eol || *p++ != ',' ||
+        !scan_int(&p, eol, &job->run_time) || p == eol || *p++ != ',' ||
+        !scan_int(&p, eol, &job->priority) || (p != eol && *p != ',')){
+      fprintf(stderr, "Illegal file format on line %d.\n", cursor->line);
+      cursor->error = 1;
+      return 0;
+    }
+
+    //the deadline column may be missing or blank, columns after it are ignored
+    job->deadline = -1;
+    if(p != eol){
+      p++;
+      while(p < eol && (*p == ' ' || *p == '\t' || *p == '\r')){
+        p++;
+      }
+      if(p != eol && *p != ',' && (!scan_int(&p, eol, &job->deadline) || (p != eol && *p != ','))){
+        fprintf(stderr, "Illegal file format on line %d.\n", cursor->line);
+        cursor->error = 1;
+        return 0;
+      }
+    }
+
+    return 1;
+  }
+
+  return 0;
+}
+
+
+//reads the next record of a binary trace straight from the mapping
+static int next_binary_job(trace_cursor_t *cursor, trace_job_t *job)
+{
+  const trace_header_t *header = (const trace_header_t *)cursor->trace->data;
+
+  if((uint64_t)cursor->job_count >= header->job_count){
+    return 0;
+  }
+
+  const trace_record_t *record = (const trace_record_t *)cursor->pos;
+  job->arrival_time = record->arrival_time;
+  job->run_time = record->run_time;
+  job->priority = record->priority;
+  job->deadline = (header->version == 1) ? -1 : record->deadline;
+
+  cursor->pos += header->record_size;
+  cursor->line++;
+  return 1;
+}
+
+
+/**
+  Reads the next job of the trace into cursor->next.
+
+  cursor->has_next is cleared at the end of the trace, or when the job is
+  malformed, in which case cursor->error is set and a message naming the
+  line (or record) was printed.
+
+  @param cursor a cursor started with trace_begin()
+ */
+void trace_advance(trace_cursor_t *cursor)
+{
+  trace_job_t *job = &cursor->next;
+  int found = 0;
+
+  cursor->has_next = 0;
+
+  if(!cursor->error){
+    found = cursor->trace->binary ? next_binary_job(cursor, job) : next_csv_job(cursor, job);
+  }
+
+  if(found){
+    if(job->arrival_time < 0 || job->run_time <= 0){
+      fprintf(stderr, "Line %d needs a non-negative arrival time and a positive running time.\n", cursor->line);
+      cursor->error = 1;
+    }
+    else if(job->deadline < -1){
+      fprintf(stderr, "Line %d needs a non-negative deadline, or -1 for none.\n", cursor->line);
+      cursor->error = 1;
+    }
+    else if((cursor->sorted || cursor->trace->binary) && job->arrival_time < cursor->last_arrival){
+      fprintf(stderr, "Line %d arrives before the line above it; jobs must be sorted by arrival time.\n", cursor->line);
+      cursor->error = 1;
+    }
+    else{
+      job->job_id = cursor->job_count++;
+      cursor->last_arrival = job->arrival_time;
+      cursor->has_next = 1;
+    }
+  }
+
+  //let go of whole pages that are behind us
+  if(cursor->released != NULL && cursor->pos - cursor->released >= TRACE_RELEASE_BYTES){
+    long page = sysconf(_SC_PAGESIZE);
+    const char *upto = cursor->released + (cursor->pos - cursor->released) / page * page;
+
+    madvise((void *)cursor->released, upto - cursor->released, MADV_DONTNEED);
+    cursor->released = upto;
+  }
+}
+
+
+/**
+  Starts a cursor at the first job of a trace and reads it.
+
+  Binary traces are always sorted by arrival time.
+
+  @param cursor the cursor to start
+  @param trace a trace opened with trace_open(), shared read-only by any number of cursors
+  @param sorted if non-zero, a CSV job that arrives before the one above it is an error
+  @param release if non-zero, pages of the mapping are given back once the cursor has passed them
+ */
+void trace_begin(trace_cursor_t *cursor, const trace_t *trace, int sorted, int release)
+{
+  cursor->trace = trace;
+  cursor->pos = trace->data;
+  cursor->end = trace->data + trace->size;
+  cursor->released = (release && trace->data != NULL) ? trace->data : NULL;
+  cursor->line = 1;
+  cursor->job_count = 0;
+  cursor->last_arrival = 0;
+  cursor->sorted = sorted;
+  cursor->error = 0;
+
+  if(trace->binary){
+    cursor->pos += sizeof(trace_header_t);
+    cursor->line = 0;
+  }
+  else{
+    //ignore the first (header) line
+    const char *eol = (trace->size > 0) ? memchr(cursor->pos, '\n', trace->size) : NULL;
+    cursor->pos = (eol != NULL) ? eol + 1 : cursor->end;
+  }
+
+  trace_advance(cursor);
+}
+
+
+/**
+  Counts the jobs of a trace without keeping them.
+
+  Binary traces answer from their header; CSV traces are scanned.
+
+  @param trace a trace opened with trace_open()
+  @return the number of jobs
+  @return -1 if the trace is malformed
+ */
+int trace_count_jobs(const trace_t *trace)
+{
+  trace_cursor_t cursor;
+
+  if(trace->binary){
+    return ((const trace_header_t *)trace->data)->job_count;
+  }
+
+  trace_begin(&cursor, trace, 0, 0);
+  while(cursor.has_next){
+    trace_advance(&cursor);
+  }
+
+  return cursor.error ? -1 : cursor.job_count;
+}
+
+
+/**
+  Writes the header of a binary trace.
+
+  Exactly job_count calls to trace_write_job() must follow, in order of
+  arrival time.
+
+  @param file the file to write to, opened in binary mode
+  @param job_count how many jobs the trace will hold
+  @return 1 on success, 0 on a write error
+ */
+int trace_write_header(FILE *file, uint64_t job_count)
+{
+  trace_header_t header;
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, TRACE_MAGIC, 8);
+  header.version = TRACE_VERSION;
+  header.byte_order = TRACE_BYTE_ORDER;
+  header.record_size = sizeof(trace_record_t);
+  header.job_count = job_count;
+
+  return fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+
+/**
+  Appends one job to a binary trace.
+
+  @param file the file the header was written to
+  @param job the job; its job_id is implied by its position, a deadline of -1 means none
+  @return 1 on success, 0 on a write error
+ */
+int trace_write_job(FILE *file, const trace_job_t *job)
+{
+  trace_record_t record;
+
+  record.arrival_time = job->arrival_time;
+  record.run_time = job->run_time;
+  record.priority = job->priority;
+  record.deadline = job->deadline;
+
+  return fwrite(&record, sizeof(record), 1, file) == 1;
+}
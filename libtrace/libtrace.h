@@ -0,0 +1,93 @@
+/** @file libtrace.h
+ */
+
+#ifndef LIBTRACE_H_
+#define LIBTRACE_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+  First bytes of a binary trace
+*/
+#define TRACE_MAGIC "SCHEDTRC"
+#define TRACE_VERSION 2
+#define TRACE_BYTE_ORDER 0x01020304
+
+/**
+  How far a releasing cursor reads before giving the pages behind it back
+*/
+#define TRACE_RELEASE_BYTES (8 << 20)
+
+/**
+  Binary trace header, followed by job_count trace_record_t sorted by arrival time;
+  version 1 records stop before the deadline
+*/
+typedef struct _trace_header_t
+{
+  char magic[8];          //TRACE_MAGIC, not NUL terminated
+  uint32_t version;
+  uint32_t byte_order;    //TRACE_BYTE_ORDER as written by the producing machine
+  uint32_t record_size;   //sizeof(trace_record_t)
+  uint32_t reserved;
+  uint64_t job_count;
+} trace_header_t;
+
+/**
+  One job of a binary trace
+*/
+typedef struct _trace_record_t
+{
+  int32_t arrival_time;
+  int32_t run_time;
+  int32_t priority;
+  int32_t deadline;       //absolute, -1 if none
+} trace_record_t;
+
+/**
+  One job as read from a trace, numbered in trace order
+*/
+typedef struct _trace_job_t
+{
+  int job_id, arrival_time, run_time, priority;
+  int deadline;           //absolute time it should finish by, -1 if the trace gives none
+} trace_job_t;
+
+/**
+  A trace file mapped read-only; every reader goes through its own trace_cursor_t
+*/
+typedef struct _trace_t
+{
+  const char *data;
+  size_t size;
+  int binary;             //data starts with a trace_header_t
+} trace_t;
+
+/**
+  Read position in a trace_t
+*/
+typedef struct _trace_cursor_t
+{
+  const trace_t *trace;
+  const char *pos, *end;
+  const char *released;   //start of the mapping still resident for this cursor, NULL to keep it all
+  int line, job_count, last_arrival;
+  int sorted;             //reject jobs that arrive before the one above them
+
+  trace_job_t next;       //the job read next, valid while has_next
+  int has_next;
+  int error;
+} trace_cursor_t;
+
+
+int  trace_open         (trace_t *trace, const char *file_name);
+void trace_close        (trace_t *trace);
+void trace_begin        (trace_cursor_t *cursor, const trace_t *trace, int sorted, int release);
+void trace_advance      (trace_cursor_t *cursor);
+int  trace_count_jobs   (const trace_t *trace);
+
+int  trace_write_header (FILE *file, uint64_t job_count);
+int  trace_write_job    (FILE *file, const trace_job_t *job);
+
+#endif /* LIBTRACE_H_ */
@@ -3,8 +3,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <pthread.h>
 
 #include "libpriqueue/libpriqueue.h"
+#include "libscheduler/libscheduler.h"
 
 int compare1(const void * a, const void * b)
 {
@@ -16,12 +19,31 @@ int compare2(const void * a, const void * b)
 	return ( *(int*)b - *(int*)a );
 }
 
-int main()
+int compare_tens(const void * a, const void * b)
+{
+	return ( *(int*)a / 10 - *(int*)b / 10 );
+}
+
+typedef struct _item_t
+{
+	int key;
+	int slot;
+} item_t;
+
+int compare_items(const void * a, const void * b)
 {
-	priqueue_t q, q2;
+	return ( ((item_t*)a)->key - ((item_t*)b)->key );
+}
+
+void test_engine(priqueue_engine_t engine, const char *name)
+{
+	priqueue_t q, q2, q3, q4;
+
+	printf("== %s engine ==\n", name);
 
-	priqueue_init(&q, compare1);
-	priqueue_init(&q2, compare2);
+	priqueue_init_engine(&q, compare1, engine);
+	priqueue_init_engine(&q2, compare2, engine);
+	priqueue_init_engine(&q3, compare_tens, engine);
 
 	/* Pupulate some data... */
 	int *values = malloc(100 * sizeof(int));
@@ -64,10 +86,262 @@ int main()
 		printf("%d ", *((int *)priqueue_at(&q2, i)) );
 	printf("\n");
 
+	val = *((int *)priqueue_remove_at(&q, 2));
+	printf("Removed at 2: %d (expected 14).\n", val);
+
+	/* Equal keys must come back in the order they were offered. */
+	priqueue_offer(&q3, &values[25]);
+	priqueue_offer(&q3, &values[12]);
+	priqueue_offer(&q3, &values[21]);
+	priqueue_offer(&q3, &values[18]);
+	priqueue_offer(&q3, &values[3]);
+	priqueue_offer(&q3, &values[27]);
+
+	printf("Ties in offer order (expected 3 12 18 25 21 27): ");
+	while (priqueue_size(&q3) > 0)
+		printf("%d ", *((int *)priqueue_poll(&q3)) );
+	printf("\n");
+
+	/* Re-key and remove through the embedded index slot. */
+	item_t items[5] = { {50, -1}, {10, -1}, {40, -1}, {20, -1}, {30, -1} };
+
+	priqueue_init_engine(&q4, compare_items, engine);
+	priqueue_set_slot(&q4, offsetof(item_t, slot));
+
+	for (i = 0; i < 5; i++)
+		priqueue_offer(&q4, &items[i]);
+
+	items[0].key = 5;
+	priqueue_update(&q4, &items[0]);
+	items[1].key = 30;
+	priqueue_update(&q4, &items[1]);
+
+	printf("Elements removed by handle: %d (expected 1).\n", priqueue_remove(&q4, &items[2]));
+	printf("Elements removed by handle: %d (expected 0).\n", priqueue_remove(&q4, &items[2]));
+
+	printf("Re-keyed order (expected 5 20 30 30): ");
+	while (priqueue_size(&q4) > 0)
+		printf("%d ", ((item_t *)priqueue_poll(&q4))->key );
+	printf("\n");
+
+	/* Once warmed up, churning the queue must not touch the heap. */
+	pool_stats_t before, after;
+
+	for (i = 0; i < 100; i++)
+		priqueue_offer(&q3, &values[(i * 37) % 100]);
+	while (priqueue_size(&q3) > 0)
+		priqueue_poll(&q3);
+	priqueue_stats(&q3, &before);
+
+	int round;
+	for (round = 0; round < 5; round++)
+	{
+		for (i = 0; i < 100; i++)
+			priqueue_offer(&q3, &values[(i * 61 + round) % 100]);
+		priqueue_at(&q3, 50);
+		priqueue_remove_at(&q3, 10);
+		while (priqueue_size(&q3) > 0)
+			priqueue_poll(&q3);
+	}
+	priqueue_stats(&q3, &after);
+	printf("Heap calls after warm-up: %ld (expected 0).\n", after.heap_calls - before.heap_calls);
+
+	priqueue_destroy(&q4);
+	priqueue_destroy(&q3);
 	priqueue_destroy(&q2);
 	priqueue_destroy(&q);
 
 	free(values);
+}
+
+#define STRESS_THREADS 4
+#define STRESS_ITEMS 50000
+
+/* One producer or consumer of the concurrent stress test. */
+typedef struct _stress_t
+{
+	cpriqueue_t *q;
+	item_t *items;
+	int *seen;            /* times each item was polled */
+	int *polled;          /* items polled by every consumer so far */
+	int first;            /* first item this producer offers */
+} stress_t;
+
+void *stress_produce(void *arg)
+{
+	stress_t *s = arg;
+	int i;
+
+	for (i = s->first; i < s->first + STRESS_ITEMS; i++)
+		cpriqueue_offer(s->q, &s->items[i]);
+	return NULL;
+}
+
+void *stress_consume(void *arg)
+{
+	stress_t *s = arg;
+
+	while (__atomic_load_n(s->polled, __ATOMIC_ACQUIRE) < STRESS_THREADS * STRESS_ITEMS)
+	{
+		item_t *item = cpriqueue_poll(s->q);
+		if (item == NULL)
+			continue;
+
+		__atomic_add_fetch(&s->seen[item - s->items], 1, __ATOMIC_RELAXED);
+		__atomic_add_fetch(s->polled, 1, __ATOMIC_RELEASE);
+	}
+	return NULL;
+}
+
+void test_concurrent()
+{
+	cpriqueue_t q;
+	int i;
+
+	printf("== concurrent queue ==\n");
+
+	/* A single part is an exact queue. */
+	item_t few[4] = { {30, -1}, {10, -1}, {20, -1}, {10, -1} };
+
+	cpriqueue_init(&q, compare_items, 1);
+	for (i = 0; i < 4; i++)
+		cpriqueue_offer(&q, &few[i]);
+
+	printf("Top element: %d (expected 10).\n", ((item_t *)cpriqueue_peek(&q))->key);
+	printf("Single part order (expected 10 10 20 30): ");
+	while (cpriqueue_size(&q) > 0)
+		printf("%d ", ((item_t *)cpriqueue_poll(&q))->key );
+	printf("\n");
+	printf("Poll on empty: %s (expected NULL).\n", cpriqueue_poll(&q) == NULL ? "NULL" : "element");
+	cpriqueue_destroy(&q);
+
+	/* Producers and consumers race; every element must come out exactly once. */
+	item_t *items = malloc(STRESS_THREADS * STRESS_ITEMS * sizeof(item_t));
+	int *seen = calloc(STRESS_THREADS * STRESS_ITEMS, sizeof(int));
+	int polled = 0, once = 0;
+	pthread_t producers[STRESS_THREADS], consumers[STRESS_THREADS];
+	stress_t stress[STRESS_THREADS];
+
+	for (i = 0; i < STRESS_THREADS * STRESS_ITEMS; i++)
+	{
+		items[i].key = (i * 7919) % 1000;
+		items[i].slot = -1;
+	}
+
+	cpriqueue_init(&q, compare_items, 2 * STRESS_THREADS);
+	for (i = 0; i < STRESS_THREADS; i++)
+	{
+		stress[i].q = &q;
+		stress[i].items = items;
+		stress[i].seen = seen;
+		stress[i].polled = &polled;
+		stress[i].first = i * STRESS_ITEMS;
+		pthread_create(&consumers[i], NULL, stress_consume, &stress[i]);
+		pthread_create(&producers[i], NULL, stress_produce, &stress[i]);
+	}
+	for (i = 0; i < STRESS_THREADS; i++)
+	{
+		pthread_join(producers[i], NULL);
+		pthread_join(consumers[i], NULL);
+	}
+
+	for (i = 0; i < STRESS_THREADS * STRESS_ITEMS; i++)
+		once += (seen[i] == 1);
+	printf("Elements polled exactly once: %d (expected %d).\n", once, STRESS_THREADS * STRESS_ITEMS);
+	printf("Total elements: %d (expected 0).\n", cpriqueue_size(&q));
+
+	cpriqueue_destroy(&q);
+	free(seen);
+	free(items);
+}
+
+void test_scheduler()
+{
+	printf("== scheduler ==\n");
+
+	/* A quantum expiring on an idle core must not make the core look idle twice. */
+	scheduler_t *s = scheduler_create(2, RR);
+
+	printf("Quantum expired on idle core: %d (expected -1).\n", scheduler_quantum_expired_r(s, 1, 0));
+	printf("Cores of three arrivals (expected 0 1 -1): ");
+	printf("%d ", scheduler_new_job_r(s, 0, 1, 10, 0));
+	printf("%d ", scheduler_new_job_r(s, 1, 2, 10, 0));
+	printf("%d ", scheduler_new_job_r(s, 2, 3, 10, 0));
+	printf("\n");
+
+	scheduler_destroy(s);
+
+	/* Each scheduler keeps the settings it was created with, whatever the setters say. */
+	scheduler_config_t config;
+	scheduler_config_init(&config);
+	config.mlfq_levels = 2;
+	config.mlfq_quanta[0] = 5;
+	config.mlfq_quanta[1] = 7;
+
+	int quanta[] = { 9 };
+	scheduler_mlfq(1, quanta, 0);
+
+	scheduler_t *configured = scheduler_create_ex(1, MLFQ, &config);
+	scheduler_t *plain = scheduler_create(1, MLFQ);
+	scheduler_new_job_r(configured, 0, 0, 100, 0);
+	scheduler_new_job_r(plain, 0, 0, 100, 0);
+	printf("Time slices of configured and default MLFQ: %d %d (expected 5 2).\n",
+			scheduler_time_slice_r(configured, 0), scheduler_time_slice_r(plain, 0));
+
+	scheduler_destroy(configured);
+	scheduler_destroy(plain);
+
+	/* Levels past the quanta given default to twice the level above. */
+	scheduler_config_init(&config);
+	config.mlfq_levels = 5;
+
+	scheduler_t *deep = scheduler_create_ex(1, MLFQ, &config);
+	int time = 0;
+	scheduler_new_job_r(deep, 0, time, 1000, 0);
+	printf("Quanta of 5 MLFQ levels (expected 2 4 8 16 32): ");
+	for (int level = 0; level < 5; level++)
+	{
+		int slice = scheduler_time_slice_r(deep, 0);
+		printf("%d ", slice);
+		time += slice;
+		scheduler_quantum_expired_r(deep, 0, time);
+	}
+	printf("\n");
+
+	scheduler_destroy(deep);
+}
+
+/*
+ * A preempted PSJF job waits at its sorted place by remaining time, not where it was queued before, whatever the
+ * engine.  The queue dumps of the PSJF examples show this order rather than the reference simulator's.
+ */
+void test_psjf_queue_order(priqueue_engine_t engine, const char *name)
+{
+	scheduler_config_t config;
+	scheduler_config_init(&config);
+	config.queue_engine = engine;
+
+	scheduler_t *s = scheduler_create_ex(1, PSJF, &config);
+	scheduler_new_job_r(s, 0, 0, 10, 0);
+	scheduler_new_job_r(s, 1, 1, 20, 0);
+	scheduler_new_job_r(s, 2, 2, 2, 0);
+
+	printf("PSJF queue after a preemption, %s engine (expected 2(0) 0(-1) 1(-1)): ", name);
+	scheduler_show_queue_r(s);
+
+	scheduler_destroy(s);
+}
+
+int main()
+{
+	test_engine(PRIQUEUE_LIST, "list");
+	test_engine(PRIQUEUE_HEAP, "heap");
+	test_engine(PRIQUEUE_TREE, "tree");
+	test_concurrent();
+	test_scheduler();
+	test_psjf_queue_order(PRIQUEUE_LIST, "list");
+	test_psjf_queue_order(PRIQUEUE_HEAP, "heap");
+	test_psjf_queue_order(PRIQUEUE_TREE, "tree");
 
 	return 0;
 }
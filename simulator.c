@@ -3,37 +3,322 @@
 #include <unistd.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "libscheduler/libscheduler.h"
+#include "libpriqueue/libpriqueue.h"
+#include "libtrace/libtrace.h"
 
 
 typedef struct _simulator_job_list_t
 {
-	int job_id, arrival_time, run_time, priority;
+	int job_id, arrival_time, run_time, priority, deadline;
 	int core_id, arrived;
 } simulator_job_list_t;
 
+typedef struct _simulator_segment_t
+{
+	int job_id, start, end;
+} simulator_segment_t;
+
+typedef struct _simulator_timeline_t
+{
+	simulator_segment_t *segments;
+	int length, capacity;
+} simulator_timeline_t;
+
+typedef struct _simulator_event_t
+{
+	int time;
+	int slot;
+} simulator_event_t;
+
+typedef struct _simulator_arrival_t
+{
+	int time, job_id;
+} simulator_arrival_t;
+
+/*
+ * Jobs that have been loaded and have not finished, found by job_id through an open-addressed index and by core
+ * through core_job.  Finished jobs are replaced by the last job of the table.
+ */
+typedef struct _simulator_table_t
+{
+	simulator_job_list_t *jobs;
+	int length, capacity;
+	int *index;      // positions in jobs, or -1, probed linearly from a hash of the job_id
+	int index_mask;
+	int *core_job;   // position in jobs of the job running on each core, or -1 if idle
+} simulator_table_t;
+
+#define MAX_SWEEP_VALUES 256
+
+typedef struct _simulator_run_t
+{
+	int cores, scheme, quantum;
+	int event_driven, quiet, compact, report;
+	int stream, stats, percentiles, balance;
+	const scheduler_config_t *config;   // shared, read-only, by every run
+	char *export_file;
+	char *chrome_file;
+
+	int status, job_count;
+	float waiting_time, turnaround_time, response_time;
+	unsigned long long deadline_misses;
+	double max_share_lag;
+	unsigned long long migrations, steals;
+} simulator_run_t;
+
+#define CHROME_BUFFER_SIZE (64 * 1024)
+
+/*
+ * A Chrome Trace Event JSON file written while the simulation runs.  Every core is a thread whose jobs are B/E slices,
+ * arrivals go to one more thread after the cores, and events are formatted by hand into a buffer written out whole.
+ */
+typedef struct _simulator_chrome_t
+{
+	FILE *file;
+	char *buffer;
+	size_t length;
+	int events, cores, ok;
+	int *core_job;   // job with an open slice on each core, or -1
+} simulator_chrome_t;
+
+typedef struct _simulator_sweep_t
+{
+	const trace_t *trace;   // shared, read-only, by every run
+
+	simulator_run_t *runs;
+	int run_count, next_run;
+	pthread_mutex_t lock;
+} simulator_sweep_t;
+
+int event_compare(const void *a, const void *b)
+{
+	return ((simulator_event_t *)a)->time - ((simulator_event_t *)b)->time;
+}
+
+int arrival_compare(const void *a, const void *b)
+{
+	const simulator_arrival_t *x = a, *y = b;
+
+	if (x->time != y->time)
+		return x->time - y->time;
+	return x->job_id - y->job_id;
+}
+
+int int_compare(const void *a, const void *b)
+{
+	return *(int *)a - *(int *)b;
+}
+
 void print_usage(char *program_name)
 {
-	fprintf(stderr, "Usage: %s -c <cores> -s <scheme> <input file>\n", program_name);
+	fprintf(stderr, "Usage: %s -c <cores> -s <scheme> [-e] [-q] [-d] [-l] [-p] [-i] [-x <file>] [-t <file>] [-Q <engine>] [-M <quanta>] [-B <period>] [-L <latency>] [-G <granularity>] [-P <quantum>] [-R <seed>] [-W <affinity>] [-K <factor>] <input file>\n", program_name);
 	fprintf(stderr, "       %s -c 2 -s fcfs examples/proc1.csv\n", program_name);
 	fprintf(stderr, "\n");
-	fprintf(stderr, "Acceptable schemes are: fcfs, sjf, psjf, pri, ppri, rr#\n");
+	fprintf(stderr, "Acceptable schemes are: fcfs, sjf, psjf, pri, ppri, rr#, mlfq, edf, cfs, stride, lottery\n");
+	fprintf(stderr, "Acceptable queue engines are: list (default), heap, tree\n");
+	fprintf(stderr, "The input file is a CSV or a binary trace written by traceconv.\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "  -e  event-driven: jump to the next arrival, finish or quantum expiry\n");
+	fprintf(stderr, "      instead of printing every time unit\n");
+	fprintf(stderr, "  -q  quiet: print only the averages (implies -e)\n");
+	fprintf(stderr, "  -d  print the final timeline as compact job@start-end runs\n");
+	fprintf(stderr, "  -l  stream the trace, keeping only live jobs in memory; the input must be sorted\n");
+	fprintf(stderr, "      by arrival time, and jobs finishing or arriving together are handled in job order,\n");
+	fprintf(stderr, "      which may schedule such ties differently from a loaded run\n");
+	fprintf(stderr, "  -x  export the timeline segments to <file>, as JSON if it ends in .json, CSV otherwise\n");
+	fprintf(stderr, "  -t  stream every arrival, dispatch, preemption, quantum expiry and finish to <file>\n");
+	fprintf(stderr, "      as Chrome Trace Event JSON for Perfetto or chrome://tracing, a time unit shown as 1us\n");
+	fprintf(stderr, "  -p  print p50/p90/p99/max of the times next to the averages, also per priority\n");
+	fprintf(stderr, "  -i  print the scheduler's migrations, and its call counts, latencies and preemptions\n");
+	fprintf(stderr, "      (make STATS=1)\n");
+	fprintf(stderr, "  -M  quanta of the mlfq levels, top level first (default: 2,4,8)\n");
+	fprintf(stderr, "  -B  move every mlfq job back to the top level every <period> time units (default: never)\n");
+	fprintf(stderr, "  -L  time units in which cfs runs every runnable job once, shared out by priority (default: 24)\n");
+	fprintf(stderr, "  -G  shortest slice cfs gives a job (default: 3)\n");
+	fprintf(stderr, "  -P  quantum of stride and lottery, whose jobs hold tickets by priority (default: 2)\n");
+	fprintf(stderr, "  -R  seed of the lottery draws (default: 1)\n");
+	fprintf(stderr, "      cfs, stride and lottery print how far jobs got from their share by priority\n");
+	fprintf(stderr, "  -W  give every core its own run queue; an idle core steals half of the longest one\n");
+	fprintf(stderr, "      if it holds more than <affinity> jobs, 0 to always steal; prints migrations and steals\n");
+	fprintf(stderr, "  -K  jobs without a deadline column must finish by arrival + <factor> x running time (default: 2)\n");
+	fprintf(stderr, "      deadline misses and lateness are printed for edf and for traces with deadlines\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Sweep: %s -S <csv> [-j <threads>] [-r <quanta>] [-l] -c <cores,...> -s <scheme,...> <input file>\n", program_name);
+	fprintf(stderr, "       %s -S sweep.csv -c 1,2,4 -s fcfs,psjf,rr -r 1,2,4 examples/proc1.csv\n", program_name);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "  -S  run every scheme on every core count on a thread pool and write the averages\n");
+	fprintf(stderr, "      to <csv> (- for stdout), one row per configuration\n");
+	fprintf(stderr, "  -j  number of threads (default: one per online CPU)\n");
+	fprintf(stderr, "  -r  quanta that a bare rr is expanded into\n");
+}
+
+/*
+ * Where job_id's entry is, or would go, in the table's index.
+ */
+int table_probe(simulator_table_t *table, int job_id)
+{
+	int h = ((unsigned int)job_id * 2654435761u) & table->index_mask;
+
+	while (table->index[h] != -1 && table->jobs[table->index[h]].job_id != job_id)
+		h = (h + 1) & table->index_mask;
+
+	return h;
+}
+
+/*
+ * Returns the position of job_id in the table, or -1 if it is not there.
+ */
+int table_find(simulator_table_t *table, int job_id)
+{
+	return table->index[table_probe(table, job_id)];
 }
 
-int set_active_job(int job_id, int core_id, simulator_job_list_t *jobs, int active_jobs)
+int table_init(simulator_table_t *table, int cores)
 {
 	int i;
-	for (i = 0; i < active_jobs; i++)
+
+	table->length = 0;
+	table->capacity = 16;
+	table->index_mask = 31;
+	table->jobs = malloc(table->capacity * sizeof(simulator_job_list_t));
+	table->index = malloc((table->index_mask + 1) * sizeof(int));
+	table->core_job = malloc(cores * sizeof(int));
+
+	if (table->jobs == NULL || table->index == NULL || table->core_job == NULL)
+		return 0;
+
+	for (i = 0; i <= table->index_mask; i++)
+		table->index[i] = -1;
+	for (i = 0; i < cores; i++)
+		table->core_job[i] = -1;
+
+	return 1;
+}
+
+void table_destroy(simulator_table_t *table)
+{
+	free(table->jobs);
+	free(table->index);
+	free(table->core_job);
+}
+
+/*
+ * Adds job to the end of the table, idle and not yet arrived.  Returns 0 if out of memory.
+ */
+int table_add(simulator_table_t *table, const trace_job_t *job)
+{
+	int i;
+
+	if (table->length == table->capacity)
+	{
+		simulator_job_list_t *grown = realloc(table->jobs, 2 * table->capacity * sizeof(simulator_job_list_t));
+		if (grown == NULL)
+			return 0;
+
+		table->jobs = grown;
+		table->capacity *= 2;
+	}
+
+	// Keep the index at most half full
+	if (2 * (table->length + 1) > table->index_mask + 1)
+	{
+		int *grown = malloc(2 * (table->index_mask + 1) * sizeof(int));
+		if (grown == NULL)
+			return 0;
+
+		free(table->index);
+		table->index = grown;
+		table->index_mask = 2 * table->index_mask + 1;
+
+		for (i = 0; i <= table->index_mask; i++)
+			table->index[i] = -1;
+		for (i = 0; i < table->length; i++)
+			table->index[table_probe(table, table->jobs[i].job_id)] = i;
+	}
+
+	simulator_job_list_t *added = &table->jobs[table->length];
+	added->job_id = job->job_id;
+	added->arrival_time = job->arrival_time;
+	added->run_time = job->run_time;
+	added->priority = job->priority;
+	added->deadline = job->deadline;
+	added->core_id = -1;
+	added->arrived = 0;
+
+	table->index[table_probe(table, job->job_id)] = table->length++;
+	return 1;
+}
+
+/*
+ * Deletes the job at position, moving the last job of the table into its place.
+ */
+void table_remove(simulator_table_t *table, int position)
+{
+	simulator_job_list_t *job = &table->jobs[position];
+	int mask = table->index_mask;
+	int hole = table_probe(table, job->job_id), h = hole;
+
+	if (job->core_id != -1)
+		table->core_job[job->core_id] = -1;
+
+	// Close the hole in the index by shifting back later entries of the same probe run
+	table->index[hole] = -1;
+	while (table->index[h = (h + 1) & mask] != -1)
 	{
-		if (jobs[i].job_id == job_id && jobs[i].arrived)
+		int home = ((unsigned int)table->jobs[table->index[h]].job_id * 2654435761u) & mask;
+
+		if ((h > hole) ? (home <= hole || home > h) : (home <= hole && home > h))
 		{
-			jobs[i].core_id = core_id;
-			return 1;
+			table->index[hole] = table->index[h];
+			table->index[h] = -1;
+			hole = h;
 		}
 	}
 
-	return 0;
+	int last = --table->length;
+	if (position != last)
+	{
+		table->index[table_probe(table, table->jobs[last].job_id)] = position;
+		table->jobs[position] = table->jobs[last];
+
+		if (job->core_id != -1)
+			table->core_job[job->core_id] = position;
+	}
+}
+
+/*
+ * Runs the job at position on core_id, or idles the core if position is -1.
+ */
+void table_run(simulator_table_t *table, int core_id, int position)
+{
+	if (table->core_job[core_id] != -1)
+		table->jobs[table->core_job[core_id]].core_id = -1;
+
+	if (position != -1 && table->jobs[position].core_id != -1)
+		table->core_job[table->jobs[position].core_id] = -1;
+
+	table->core_job[core_id] = position;
+	if (position != -1)
+		table->jobs[position].core_id = core_id;
+}
+
+int set_active_job(int job_id, int core_id, simulator_table_t *table)
+{
+	int position = table_find(table, job_id);
+
+	if (position == -1 || !table->jobs[position].arrived)
+		return 0;
+
+	table_run(table, core_id, position);
+	return 1;
+}
+
+simulator_job_list_t *find_core_job(int core_id, simulator_table_t *table)
+{
+	return (table->core_job[core_id] != -1) ? &table->jobs[table->core_job[core_id]] : NULL;
 }
 
 void print_available_jobs(simulator_job_list_t *jobs, int active_jobs)
@@ -55,69 +340,1280 @@ void print_available_jobs(simulator_job_list_t *jobs, int active_jobs)
 		}
 	}
 
-	if (!first)
-		printf("\n");
-}
+	if (!first)
+		printf("\n");
+}
+
+/*
+ * Returns 1 if jobs under scheme run for a quantum at a time.
+ */
+int time_sliced(int scheme)
+{
+	return scheme == RR || scheme == MLFQ || scheme == CFS || scheme == STRIDE || scheme == LOTTERY;
+}
+
+/*
+ * Reschedules core_id's event for when its job finishes or its quantum runs out.
+ */
+void set_core_event(priqueue_t *events, simulator_event_t *core_events, int core_id, simulator_job_list_t *job,
+		int time, int scheme, int *quantum_clock)
+{
+	simulator_event_t *event = &core_events[core_id];
+	priqueue_remove(events, event);
+
+	if (job == NULL)
+		return;
+
+	event->time = time + job->run_time;
+	if (time_sliced(scheme) && time + quantum_clock[core_id] < event->time)
+		event->time = time + quantum_clock[core_id];
+	priqueue_offer(events, event);
+}
+
+/*
+ * Records that job_id ran on a core for units time units from start.
+ */
+int timeline_append(simulator_timeline_t *timeline, int job_id, int start, int units)
+{
+	simulator_segment_t *last = (timeline->length > 0) ? &timeline->segments[timeline->length - 1] : NULL;
+
+	// Extend the current run when the same job keeps the core
+	if (last != NULL && last->job_id == job_id && last->end == start)
+	{
+		last->end += units;
+		return 1;
+	}
+
+	if (timeline->length == timeline->capacity)
+	{
+		timeline->capacity = (timeline->capacity == 0) ? 16 : timeline->capacity * 2;
+		timeline->segments = realloc(timeline->segments, timeline->capacity * sizeof(simulator_segment_t));
+
+		if (timeline->segments == NULL)
+			return 0;
+	}
+
+	timeline->segments[timeline->length].job_id = job_id;
+	timeline->segments[timeline->length].start = start;
+	timeline->segments[timeline->length].end = start + units;
+	timeline->length++;
+	return 1;
+}
+
+/*
+ * Prints one core's timing diagram up to end_time, one character per time unit.
+ */
+void print_timeline(simulator_timeline_t *timeline, int end_time)
+{
+	int time = 0, i;
+	char unit[14];
+
+	for (i = 0; i < timeline->length; i++)
+	{
+		simulator_segment_t *segment = &timeline->segments[i];
+
+		// If the core is idle, print a '-'
+		for (; time < segment->start; time++)
+			putchar('-');
+
+		if (segment->job_id < 10)
+			sprintf(unit, "%d", segment->job_id);
+		else if (segment->job_id < 10 + 26)
+			sprintf(unit, "%c", segment->job_id - 10 + 'a');
+		else if (segment->job_id < 10 + 26 + 26)
+			sprintf(unit, "%c", segment->job_id - 10 - 26 + 'A');
+		else
+			snprintf(unit, sizeof unit, "(%d)", segment->job_id);
+
+		for (; time < segment->end; time++)
+			fputs(unit, stdout);
+	}
+
+	for (; time < end_time; time++)
+		putchar('-');
+	printf("\n");
+}
+
+/*
+ * Prints one core's timeline as job@start-end runs, skipping idle time.
+ */
+void print_compact_timeline(simulator_timeline_t *timeline)
+{
+	int i;
+	for (i = 0; i < timeline->length; i++)
+		printf(" %d@%d-%d", timeline->segments[i].job_id, timeline->segments[i].start, timeline->segments[i].end);
+	printf("\n");
+}
+
+/*
+ * Writes every core's segments as CSV, or as JSON when file_name ends in .json.
+ */
+int export_timelines(const char *file_name, simulator_timeline_t *timelines, int cores)
+{
+	FILE *file = fopen(file_name, "w");
+	if (file == NULL)
+		return 0;
+
+	size_t name_length = strlen(file_name);
+	int json = (name_length >= 5 && strcasecmp(file_name + name_length - 5, ".json") == 0);
+	int i, j, first = 1;
+
+	fprintf(file, json ? "[\n" : "core,job,start,end\n");
+	for (i = 0; i < cores; i++)
+	{
+		for (j = 0; j < timelines[i].length; j++)
+		{
+			simulator_segment_t *segment = &timelines[i].segments[j];
+
+			if (json)
+				fprintf(file, "%s  {\"core\": %d, \"job\": %d, \"start\": %d, \"end\": %d}",
+						first ? "" : ",\n", i, segment->job_id, segment->start, segment->end);
+			else
+				fprintf(file, "%d,%d,%d,%d\n", i, segment->job_id, segment->start, segment->end);
+			first = 0;
+		}
+	}
+	if (json)
+		fprintf(file, "%s]\n", first ? "" : "\n");
+
+	return fclose(file) == 0;
+}
+
+void chrome_flush(simulator_chrome_t *chrome)
+{
+	if (chrome->length > 0 && fwrite(chrome->buffer, chrome->length, 1, chrome->file) != 1)
+		chrome->ok = 0;
+	chrome->length = 0;
+}
+
+void chrome_put(simulator_chrome_t *chrome, const char *text)
+{
+	while (*text)
+		chrome->buffer[chrome->length++] = *text++;
+}
+
+void chrome_put_int(simulator_chrome_t *chrome, int value)
+{
+	char digits[12];
+	int length = 0;
+	unsigned int v = (value < 0) ? -(unsigned int)value : (unsigned int)value;
+
+	do
+	{
+		digits[length++] = '0' + v % 10;
+		v /= 10;
+	} while (v > 0);
+
+	if (value < 0)
+		chrome->buffer[chrome->length++] = '-';
+	while (length > 0)
+		chrome->buffer[chrome->length++] = digits[--length];
+}
+
+/*
+ * Starts one event of the given phase on thread tid, named name or "job <job_id>" if name is NULL, and opens its
+ * args with the job; the caller may add args before chrome_end().
+ */
+void chrome_begin(simulator_chrome_t *chrome, const char *phase, const char *name, int time, int tid, int job_id)
+{
+	// no event comes near 512 bytes
+	if (chrome->length > CHROME_BUFFER_SIZE - 512)
+		chrome_flush(chrome);
+
+	chrome_put(chrome, chrome->events++ ? ",\n{\"ph\":\"" : "\n{\"ph\":\"");
+	chrome_put(chrome, phase);
+	chrome_put(chrome, "\",\"name\":\"");
+	if (name != NULL)
+		chrome_put(chrome, name);
+	else
+	{
+		chrome_put(chrome, "job ");
+		chrome_put_int(chrome, job_id);
+	}
+	chrome_put(chrome, "\",\"ts\":");
+	chrome_put_int(chrome, time);
+	chrome_put(chrome, ",\"pid\":1,\"tid\":");
+	chrome_put_int(chrome, tid);
+	chrome_put(chrome, ",\"args\":{\"job\":");
+	chrome_put_int(chrome, job_id);
+}
+
+void chrome_end(simulator_chrome_t *chrome)
+{
+	chrome_put(chrome, "}}");
+}
+
+/*
+ * Names the process and a thread per core, so Perfetto lists them in order.
+ */
+void chrome_name(simulator_chrome_t *chrome, const char *what, const char *name, int tid, int number)
+{
+	chrome_put(chrome, chrome->events++ ? ",\n{\"ph\":\"M\",\"name\":\"" : "\n{\"ph\":\"M\",\"name\":\"");
+	chrome_put(chrome, what);
+	chrome_put(chrome, "\",\"pid\":1,\"tid\":");
+	chrome_put_int(chrome, tid);
+	chrome_put(chrome, ",\"args\":{\"name\":\"");
+	chrome_put(chrome, name);
+	if (number >= 0)
+		chrome_put_int(chrome, number);
+	chrome_put(chrome, "\"}}");
+}
+
+int chrome_open(simulator_chrome_t *chrome, const char *file_name, int cores, const char *title)
+{
+	int i;
+
+	chrome->file = fopen(file_name, "w");
+	chrome->buffer = malloc(CHROME_BUFFER_SIZE);
+	chrome->core_job = malloc(cores * sizeof(int));
+	chrome->length = 0;
+	chrome->events = 0;
+	chrome->cores = cores;
+	chrome->ok = 1;
+
+	if (chrome->file == NULL || chrome->buffer == NULL || chrome->core_job == NULL)
+		return 0;
+
+	chrome_put(chrome, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	chrome_name(chrome, "process_name", title, 0, -1);
+	for (i = 0; i < cores; i++)
+	{
+		chrome->core_job[i] = -1;
+		chrome_name(chrome, "thread_name", "Core ", i, i);
+		if (chrome->length > CHROME_BUFFER_SIZE - 512)
+			chrome_flush(chrome);
+	}
+	chrome_name(chrome, "thread_name", "Arrivals", cores, -1);
+
+	return 1;
+}
+
+/*
+ * Closes the slice of the job on core_id, if any, and opens one for job_id unless it is -1.
+ */
+void chrome_switch(simulator_chrome_t *chrome, int core_id, int time, int job_id)
+{
+	if (chrome->core_job[core_id] != -1)
+	{
+		chrome_begin(chrome, "E", NULL, time, core_id, chrome->core_job[core_id]);
+		chrome_end(chrome);
+	}
+
+	chrome->core_job[core_id] = job_id;
+	if (job_id != -1)
+	{
+		chrome_begin(chrome, "B", NULL, time, core_id, job_id);
+		chrome_end(chrome);
+	}
+}
+
+/*
+ * Marks an instant event of job_id on thread tid.
+ */
+void chrome_instant(simulator_chrome_t *chrome, const char *name, int time, int tid, int job_id)
+{
+	chrome_begin(chrome, "i", name, time, tid, job_id);
+	chrome_put(chrome, "},\"s\":\"t\"}");
+}
+
+void chrome_arrival(simulator_chrome_t *chrome, int time, const simulator_job_list_t *job)
+{
+	chrome_begin(chrome, "i", "arrival", time, chrome->cores, job->job_id);
+	chrome_put(chrome, ",\"run_time\":");
+	chrome_put_int(chrome, job->run_time);
+	chrome_put(chrome, ",\"priority\":");
+	chrome_put_int(chrome, job->priority);
+	if (job->deadline != -1)
+	{
+		chrome_put(chrome, ",\"deadline\":");
+		chrome_put_int(chrome, job->deadline);
+	}
+	chrome_put(chrome, "},\"s\":\"t\"}");
+}
+
+/*
+ * Ends the slices still open at time, finishes the JSON and closes the file.  Returns 0 if anything failed to write.
+ */
+int chrome_close(simulator_chrome_t *chrome, int time)
+{
+	int i;
+
+	if (chrome->file != NULL && chrome->buffer != NULL && chrome->core_job != NULL)
+	{
+		for (i = 0; i < chrome->cores; i++)
+			chrome_switch(chrome, i, time, -1);
+
+		chrome_put(chrome, "\n]}\n");
+		chrome_flush(chrome);
+	}
+	else
+		chrome->ok = 0;
+
+	if (chrome->file != NULL && fclose(chrome->file) != 0)
+		chrome->ok = 0;
+
+	free(chrome->buffer);
+	free(chrome->core_job);
+	return chrome->ok;
+}
+
+void print_available_cores(int cores)
+{
+	printf("Active cores are: ");
+
+	int i;
+	for (i = 0; i < cores; i++)
+	{
+		if (i == cores - 1)
+			printf("%d\n", i);
+		else
+			printf("%d, ", i);
+	}
+}
+
+
+/*
+ * Parses a comma separated list of positive numbers into values, returning how many were read or 0 on error.
+ */
+int parse_number_list(char *list, int *values, int max_values)
+{
+	int count = 0;
+	char *token, *save;
+
+	for (token = strtok_r(list, ",", &save); token != NULL; token = strtok_r(NULL, ",", &save))
+	{
+		if (count == max_values || atoi(token) <= 0)
+			return 0;
+		values[count++] = atoi(token);
+	}
+
+	return count;
+}
+
+/*
+ * Parses one scheme name into scheme and quantum, returning 0 if it is not a scheme.  A bare "rr" leaves quantum at 0.
+ */
+int parse_scheme(const char *name, int *scheme, int *quantum)
+{
+	*quantum = 0;
+
+	if (strcasecmp(name, "FCFS") == 0) { *scheme = FCFS; }
+	else if (strcasecmp(name, "SJF") == 0) { *scheme = SJF; }
+	else if (strcasecmp(name, "PSJF") == 0) { *scheme = PSJF; }
+	else if (strcasecmp(name, "PRI") == 0) { *scheme = PRI; }
+	else if (strcasecmp(name, "PPRI") == 0) { *scheme = PPRI; }
+	else if (strcasecmp(name, "MLFQ") == 0) { *scheme = MLFQ; }
+	else if (strcasecmp(name, "EDF") == 0) { *scheme = EDF; }
+	else if (strcasecmp(name, "CFS") == 0) { *scheme = CFS; }
+	else if (strcasecmp(name, "STRIDE") == 0) { *scheme = STRIDE; }
+	else if (strcasecmp(name, "LOTTERY") == 0) { *scheme = LOTTERY; }
+	else if (strncasecmp(name, "RR", 2) == 0)
+	{
+		*scheme = RR;
+		*quantum = atoi(name + 2);
+	}
+	else
+		return 0;
+
+	return 1;
+}
+
+const char *scheme_name(int scheme)
+{
+	static const char *names[] = { "FCFS", "SJF", "PSJF", "PRI", "PPRI", "RR", "MLFQ", "EDF", "CFS", "STRIDE", "LOTTERY" };
+	return names[scheme];
+}
+
+/*
+ * Returns the quantum of the job now on core_id: the scheduler decides it under MLFQ, CFS, STRIDE and LOTTERY, RR uses the run's quantum.
+ */
+int core_quantum(scheduler_t *scheduler, int scheme, int quantum, int core_id)
+{
+	return (scheme == RR) ? quantum : scheduler_time_slice_r(scheduler, core_id);
+}
+
+/*
+ * Returns when the next job arrives, or -1 once every job has arrived.
+ *
+ * Streamed runs take it from the cursor, others from the loaded trace's arrivals, sorted by arrival time.
+ */
+int next_arrival_time(trace_cursor_t *cursor, const simulator_arrival_t *arrivals, int next_arrival, int job_count)
+{
+	if (arrivals == NULL)
+		return cursor->has_next ? cursor->next.arrival_time : -1;
+
+	return (next_arrival < job_count) ? arrivals[next_arrival].time : -1;
+}
+
+/*
+ * Prints one line of the percentile report, returning 0 if no job of the class finished.
+ */
+int print_summary(scheduler_t *scheduler, int priority_class, const char *indent)
+{
+	const char *names[SCHEDULER_METRICS] = { "Waiting Time:", "Turnaround Time:", "Response Time:" };
+	scheduler_summary_t summary;
+	int metric;
+
+	for (metric = 0; metric < SCHEDULER_METRICS; metric++)
+	{
+		if (!scheduler_summary_r(scheduler, metric, priority_class, &summary))
+			return 0;
+
+		printf("%s%-17s mean %.2f, p50 %d, p90 %d, p99 %d, max %d\n", indent, names[metric],
+				summary.mean, summary.p50, summary.p90, summary.p99, summary.max);
+	}
+
+	return 1;
+}
+
+/*
+ * Prints the distribution of the waiting, turnaround and response times, over every job and per priority.
+ */
+void print_percentiles(scheduler_t *scheduler)
+{
+	scheduler_summary_t summary;
+	int i;
+
+	printf("Time Percentiles:\n");
+	print_summary(scheduler, -1, "  ");
+
+	for (i = 0; i < SCHEDULER_PRIORITY_CLASSES; i++)
+	{
+		if (!scheduler_summary_r(scheduler, SCHEDULER_WAITING, i, &summary))
+			continue;
+
+		if (i == SCHEDULER_PRIORITY_CLASSES - 1)
+			printf("  Priority %d and above (%llu jobs):\n", i, (unsigned long long)summary.jobs);
+		else
+			printf("  Priority %d (%llu jobs):\n", i, (unsigned long long)summary.jobs);
+		print_summary(scheduler, i, "    ");
+	}
+}
+
+/*
+ * Prints how many jobs missed their deadline and by how much.
+ */
+void print_deadlines(scheduler_t *scheduler)
+{
+	scheduler_deadline_stats_t stats;
+
+	if (!scheduler_deadlines_r(scheduler, &stats))
+		return;
+
+	printf("Deadline Misses: %llu of %llu jobs (%.2f%%)\n", (unsigned long long)stats.misses, (unsigned long long)stats.jobs,
+			100.0 * stats.misses / stats.jobs);
+	printf("Lateness: mean %.2f, max %d; tardiness p50 %d, p90 %d, p99 %d\n", stats.mean_lateness, stats.max_lateness,
+			stats.p50, stats.p90, stats.p99);
+}
+
+/*
+ * Prints how far jobs got from the share of the cores their priority entitles them to.
+ */
+void print_shares(scheduler_t *scheduler)
+{
+	scheduler_share_stats_t stats;
+
+	if (!scheduler_shares_r(scheduler, &stats))
+		return;
+
+	printf("Share Lag: max %.2f (job %d), mean %.2f time units from the ideal share\n", stats.max_lag, stats.max_lag_job,
+			stats.mean_lag);
+}
+
+/*
+ * Prints how often jobs changed cores, and how often idle cores stole them.
+ */
+void print_balance(scheduler_t *scheduler)
+{
+	scheduler_balance_stats_t stats;
+
+	scheduler_balance_r(scheduler, &stats);
+	printf("Migrations: %llu; %llu steal(s) took %llu job(s)\n", (unsigned long long)stats.migrations,
+			(unsigned long long)stats.steals, (unsigned long long)stats.stolen);
+}
+
+/*
+ * Prints the instrumentation libscheduler collected for scheduler, if it was compiled in.
+ */
+void print_scheduler_stats(scheduler_t *scheduler)
+{
+	const char *call_names[SCHEDULER_CALLS] = { "scheduler_new_job", "scheduler_job_finished", "scheduler_quantum_expired" };
+	scheduler_stats_t stats;
+	int i;
+
+	scheduler_stats_r(scheduler, &stats);
+	if (!stats.enabled)
+	{
+		printf("Scheduler statistics were not compiled in; rebuild with make clean && make STATS=1.\n");
+		return;
+	}
+
+	printf("Scheduler Statistics (latencies in cycles):\n");
+	for (i = 0; i < SCHEDULER_CALLS; i++)
+	{
+		scheduler_call_stats_t *call = &stats.call[i];
+		if (call->calls == 0)
+			continue;
+
+		printf("  %-26s %10llu calls, mean %.1f, p50 %llu, p90 %llu, p99 %llu, max %llu, %.2f comparisons per call\n",
+				call_names[i], (unsigned long long)call->calls, (double)call->cycles / call->calls,
+				(unsigned long long)scheduler_stats_quantile(call, 0.5), (unsigned long long)scheduler_stats_quantile(call, 0.9),
+				(unsigned long long)scheduler_stats_quantile(call, 0.99), (unsigned long long)scheduler_stats_quantile(call, 1.0),
+				(double)call->comparisons / call->calls);
+	}
+	printf("  Preemptions: %llu\n", (unsigned long long)stats.preemptions);
+}
+
+/*
+ * Runs one simulation over trace, which is left untouched so that several runs can share it.
+ *
+ * By default the whole trace is loaded first, in file order, as the job table: every job is copied out of the mapping
+ * into the table, which the run then changes as jobs run.  A streamed run (run->stream) instead reads jobs out of the
+ * mapping as they arrive, copying only the live ones, and drops them as they finish, so memory follows the number of
+ * live jobs rather than the length of the trace; the trace must then be sorted by arrival time, and jobs that finish or
+ * arrive in the same time unit are handled in job order.  A loaded run handles them in job table order, as the original
+ * simulator did, which a streamed table that holds only live jobs cannot follow, so the two may schedule such ties
+ * differently.  If release is set, a streamed run gives back the pages of the trace it has read.
+ *
+ * Returns 0 and fills in the averages of run on success, or the process exit status on failure.
+ */
+int simulate(simulator_run_t *run, const trace_t *trace, int release)
+{
+	int cores = run->cores, scheme = run->scheme, quantum = run->quantum;
+	int event_driven = run->event_driven, quiet = run->quiet;
+	int record = !quiet || run->compact || run->export_file != NULL;
+	int time = 0, i, j, status = 0;
+	int jobs_alive = 0, deadlines = 0;
+
+	trace_cursor_t cursor;
+	simulator_table_t table;
+	simulator_arrival_t *arrivals = NULL;
+	int next_arrival = 0, job_count = 0;
+	int *arriving = NULL, arriving_ct = 0;
+
+	if (!table_init(&table, cores))
+	{
+		fprintf(stderr, "Out of memory.\n");
+		table_destroy(&table);
+		return 2;
+	}
+
+	trace_begin(&cursor, trace, run->stream, run->stream && release);
+
+	if (!run->stream)
+	{
+		for (; cursor.has_next; trace_advance(&cursor))
+		{
+			if (!table_add(&table, &cursor.next))
+			{
+				fprintf(stderr, "Out of memory.\n");
+				table_destroy(&table);
+				return 2;
+			}
+		}
+
+		job_count = table.length;
+		arrivals = malloc((job_count + 1) * sizeof(simulator_arrival_t));
+
+		for (i = 0; i < job_count; i++)
+		{
+			arrivals[i].time = table.jobs[i].arrival_time;
+			arrivals[i].job_id = table.jobs[i].job_id;
+		}
+		if (!trace->binary)
+			qsort(arrivals, job_count, sizeof(simulator_arrival_t), arrival_compare);
+	}
+
+	if (cursor.error)
+	{
+		free(arrivals);
+		table_destroy(&table);
+		return 2;
+	}
+
+	simulator_chrome_t chrome;
+	if (run->chrome_file != NULL)
+	{
+		char title[64];
+		snprintf(title, sizeof(title), "%s, %d core(s)", scheme_name(scheme), cores);
+
+		if (!chrome_open(&chrome, run->chrome_file, cores, title))
+		{
+			fprintf(stderr, "Unable to write file \"%s\".\n", run->chrome_file);
+			chrome_close(&chrome, 0);
+			free(arrivals);
+			table_destroy(&table);
+			return 2;
+		}
+	}
+
+	scheduler_t *scheduler = scheduler_create_ex(cores, scheme, run->config);
+
+	int *quantum_clock = malloc(cores * sizeof(int));
+	simulator_timeline_t *core_timelines = malloc(cores * sizeof(simulator_timeline_t));
+
+	for (i = 0; i < cores; i++)
+	{
+		quantum_clock[i] = -1;
+		core_timelines[i].segments = NULL;
+		core_timelines[i].length = 0;
+		core_timelines[i].capacity = 0;
+	}
+
+	/*
+	 * The event queue holds one event per busy core plus the next arrival, so
+	 * its head is the next time anything can happen.
+	 */
+	priqueue_t events;
+	simulator_event_t *core_events = malloc(cores * sizeof(simulator_event_t));
+	simulator_event_t arrival_event;
+
+	priqueue_init_engine(&events, event_compare, PRIQUEUE_HEAP);
+	priqueue_set_slot(&events, offsetof(simulator_event_t, slot));
+
+	for (i = 0; i < cores; i++)
+		core_events[i].slot = -1;
+
+	arrival_event.slot = -1;
+	arrival_event.time = next_arrival_time(&cursor, arrivals, next_arrival, job_count);
+	if (arrival_event.time != -1)
+		priqueue_offer(&events, &arrival_event);
+
+	int *finished = malloc(cores * sizeof(int));
+
+	while (table.length > 0 || cursor.has_next)
+	{
+		if (!quiet)
+			printf("=== [TIME %d] ===\n", time);
+
+		/*
+		 * 1. Check if any jobs finished in the last time unit.
+		 *
+		 * They are handled in order of their position in the job table, which changes as finished jobs are replaced
+		 * by the last job; streamed runs handle them in job order.
+		 */
+		int finished_ct = 0;
+
+		for (i = 0; i < cores; i++)
+			if (table.core_job[i] != -1 && table.jobs[table.core_job[i]].run_time == 0)
+				finished[finished_ct++] = table.jobs[table.core_job[i]].job_id;
+
+		while (finished_ct > 0)
+		{
+			int first = 0;
+			for (j = 1; j < finished_ct; j++)
+			{
+				if (run->stream ? finished[j] < finished[first]
+						: table_find(&table, finished[j]) < table_find(&table, finished[first]))
+					first = j;
+			}
+
+			i = table_find(&table, finished[first]);
+			finished[first] = finished[--finished_ct];
+
+			// Notify the scheduler has finished
+			int job_id = table.jobs[i].job_id;
+			int core_id = table.jobs[i].core_id;
+			int new_job_id = scheduler_job_finished_r(scheduler, core_id, job_id, time);
+
+			if (time_sliced(scheme))
+				quantum_clock[core_id] = core_quantum(scheduler, scheme, quantum, core_id);
+
+			// Delete the finished job
+			table_remove(&table, i);
+			jobs_alive--;
+
+			// Set the new job
+			if ( new_job_id != -1 && !set_active_job(new_job_id, core_id, &table) )
+			{
+				printf("The scheduler_job_finished() selected an invalid job (job_id == %d).\n", new_job_id);
+				print_available_jobs(table.jobs, table.length);
+				status = 3;
+				goto done;
+			}
+			else if (!quiet)
+			{
+				printf("Job %d, running on core %d, finished. Core %d is now running job %d.\n", job_id, core_id, core_id, new_job_id);
+				printf("  Queue: "); scheduler_show_queue_r(scheduler); printf("\n\n");
+			}
+
+			if (run->chrome_file != NULL)
+			{
+				chrome_instant(&chrome, "finish", time, core_id, job_id);
+				chrome_switch(&chrome, core_id, time, new_job_id);
+			}
+
+			set_core_event(&events, core_events, core_id, find_core_job(core_id, &table), time, scheme, quantum_clock);
+		}
+
+		/*
+		 * Check to see if we finished our last job.  (If we don't check here, we would run an extra time unit that will be totally idle.)
+		 */
+		if (table.length == 0 && !cursor.has_next)
+			break;
+
+		/*
+		 * 2. Check of any quantums expired in the last time unit.
+		 */
+		if (time_sliced(scheme))
+		{
+			for (i = 0; i < cores; i++)
+			{
+				if (quantum_clock[i] == 0 && table.core_job[i] != -1)
+				{
+					// Notify the scheduler the quantum has expired
+					int core_id = i;
+					int old_job_id = table.jobs[table.core_job[i]].job_id;
+					int new_job_id = scheduler_quantum_expired_r(scheduler, core_id, time);
+
+					table_run(&table, core_id, -1);
+
+					quantum_clock[core_id] = core_quantum(scheduler, scheme, quantum, core_id);
+
+					// Set the new job
+					if ( new_job_id != -1 && !set_active_job(new_job_id, core_id, &table) )
+					{
+						printf("The scheduler_quantum_expired() selected an invalid job (job_id == %d).\n", new_job_id);
+						print_available_jobs(table.jobs, table.length);
+						status = 3;
+						goto done;
+					}
+					else if (!quiet)
+					{
+						printf("Job %d, running on core %d, had its quantum expire. Core %d is now running job %d.\n", old_job_id, core_id, core_id, new_job_id);
+						printf("  Queue: "); scheduler_show_queue_r(scheduler); printf("\n\n");
+					}
+
+					if (run->chrome_file != NULL)
+					{
+						chrome_instant(&chrome, "quantum expired", time, core_id, old_job_id);
+						chrome_switch(&chrome, core_id, time, new_job_id);
+					}
+
+					set_core_event(&events, core_events, core_id, find_core_job(core_id, &table), time, scheme, quantum_clock);
+				}
+			}
+		}
+
+
+		/*
+		 * 3. Check for any new jobs that arrive in this time unit, in order of their position in the job table;
+		 * streamed runs take them in job order.
+		 */
+		int arriving_len = 0;
+
+		while (next_arrival_time(&cursor, arrivals, next_arrival, job_count) == time)
+		{
+			if (arriving_len == arriving_ct)
+			{
+				int *grown = realloc(arriving, (2 * arriving_ct + 16) * sizeof(int));
+				if (grown == NULL)
+				{
+					fprintf(stderr, "Out of memory.\n");
+					status = 2;
+					goto done;
+				}
+
+				arriving = grown;
+				arriving_ct = 2 * arriving_ct + 16;
+			}
+
+			// Streamed jobs join the job table as they arrive
+			if (run->stream)
+			{
+				if (!table_add(&table, &cursor.next))
+				{
+					fprintf(stderr, "Out of memory.\n");
+					status = 2;
+					goto done;
+				}
+
+				arriving[arriving_len++] = cursor.next.job_id;
+				trace_advance(&cursor);
+			}
+			else
+				arriving[arriving_len++] = table_find(&table, arrivals[next_arrival++].job_id);
+		}
+
+		if (cursor.error)
+		{
+			status = 2;
+			goto done;
+		}
+
+		if (arriving_len > 1)
+			qsort(arriving, arriving_len, sizeof(int), int_compare);
+
+		for (j = 0; j < arriving_len; j++)
+		{
+			i = run->stream ? table_find(&table, arriving[j]) : arriving[j];
+
+			int new_job_core_id = scheduler_new_job_deadline_r(scheduler, table.jobs[i].job_id, time, table.jobs[i].run_time,
+					table.jobs[i].priority, table.jobs[i].deadline);
+			table.jobs[i].arrived = 1;
+			jobs_alive++;
+			deadlines |= (table.jobs[i].deadline != -1);
+
+			if (run->chrome_file != NULL)
+				chrome_arrival(&chrome, time, &table.jobs[i]);
+
+			if (new_job_core_id >= 0 && new_job_core_id < cores)
+			{
+				if (!quiet)
+				{
+					printf("A new job, job %d (running time=%d, priority=%d), arrived. Job %d is now running on core %d.\n",
+							table.jobs[i].job_id, table.jobs[i].run_time, table.jobs[i].priority, table.jobs[i].job_id, new_job_core_id);
+					printf("  Queue: "); scheduler_show_queue_r(scheduler); printf("\n\n");
+				}
+
+				if (run->chrome_file != NULL)
+				{
+					if (table.core_job[new_job_core_id] != -1)
+						chrome_instant(&chrome, "preempted", time, new_job_core_id, table.jobs[table.core_job[new_job_core_id]].job_id);
+					chrome_switch(&chrome, new_job_core_id, time, table.jobs[i].job_id);
+				}
+
+				// Assign the core to the new job, taking it from whoever is using it
+				table_run(&table, new_job_core_id, i);
+
+				if (time_sliced(scheme))
+					quantum_clock[new_job_core_id] = core_quantum(scheduler, scheme, quantum, new_job_core_id);
+
+				set_core_event(&events, core_events, new_job_core_id, &table.jobs[i], time, scheme, quantum_clock);
+			}
+			else if (new_job_core_id == -1)
+			{
+				if (!quiet)
+				{
+					printf("A new job, job %d (running time=%d, priority=%d), arrived. Job %d is set to idle (-1).\n",
+							table.jobs[i].job_id, table.jobs[i].run_time, table.jobs[i].priority, table.jobs[i].job_id);
+					printf("  Queue: "); scheduler_show_queue_r(scheduler); printf("\n\n");
+				}
+			}
+			else
+			{
+				printf("The scheduler_new_job() selected an invalid core (core_id == %d).\n", new_job_core_id);
+				print_available_cores(cores);
+				status = 3;
+				goto done;
+			}
+		}
+
+		priqueue_remove(&events, &arrival_event);
+		arrival_event.time = next_arrival_time(&cursor, arrivals, next_arrival, job_count);
+		if (arrival_event.time != -1)
+			priqueue_offer(&events, &arrival_event);
+
+
+		/*
+		 * 4. Run the time unit, or in event-driven mode every unit up to the next event.
+		 */
+		int units = 1;
+
+		if (event_driven && priqueue_size(&events) > 0)
+			units = ((simulator_event_t *)priqueue_peek(&events))->time - time;
+
+		int cores_working = 0;
+
+		for (i = 0; i < cores; i++)
+		{
+			if (table.core_job[i] != -1)
+			{
+				simulator_job_list_t *job = &table.jobs[table.core_job[i]];
+
+				cores_working++;
+				job->run_time -= units;
+				quantum_clock[i] -= units;
+
+				if (record && !timeline_append(&core_timelines[i], job->job_id, time, units))
+				{
+					fprintf(stderr, "Out of memory.\n");
+					status = 3;
+					goto done;
+				}
+			}
+		}
+
+
+		/*
+		 * 5. Print data!
+		 */
+		if (!event_driven)
+		{
+			printf("At the end of time unit %d...\n", time);
+
+			for (i = 0; i < cores; i++)
+			{
+				printf("  Core %2d: ", i);
+				print_timeline(&core_timelines[i], time + units);
+			}
+
+			printf("\n");
+
+			printf("  Queue: ");
+			scheduler_show_queue_r(scheduler);
+			printf("\n");
+			printf("\n");
+		}
+
+
+		/*
+		 * 6. Sanity Checking
+		 *
+		 * - If there's a job alive (needing to be ran) and all CPUs are idle, the scheduler failed to schedule properly.
+		 */
+		if (jobs_alive > 0 && cores_working == 0)
+		{
+			printf("All cores are idle and at least one job remains unscheduled.\n");
+			print_available_jobs(table.jobs, table.length);
+			status = 3;
+			goto done;
+		}
+
+
+		/*
+		 * 7. Increase time
+		 */
+		time += units;
+	}
+
+
+	run->job_count = cursor.job_count;
+	run->waiting_time = scheduler_average_waiting_time_r(scheduler);
+	run->turnaround_time = scheduler_average_turnaround_time_r(scheduler);
+	run->response_time = scheduler_average_response_time_r(scheduler);
+
+	scheduler_deadline_stats_t deadline_stats;
+	scheduler_deadlines_r(scheduler, &deadline_stats);
+	run->deadline_misses = deadline_stats.misses;
+
+	scheduler_share_stats_t share_stats;
+	scheduler_shares_r(scheduler, &share_stats);
+	run->max_share_lag = share_stats.max_lag;
+
+	scheduler_balance_stats_t balance_stats;
+	scheduler_balance_r(scheduler, &balance_stats);
+	run->migrations = balance_stats.migrations;
+	run->steals = balance_stats.steals;
+
+	if (run->report)
+	{
+		if (run->compact)
+		{
+			printf("FINAL TIMELINE:\n");
+			for (i = 0; i < cores; i++)
+			{
+				printf("  Core %2d:", i);
+				print_compact_timeline(&core_timelines[i]);
+			}
+			printf("\n");
+		}
+		else if (!quiet)
+		{
+			printf("FINAL TIMING DIAGRAM:\n");
+			for (i = 0; i < cores; i++)
+			{
+				printf("  Core %2d: ", i);
+				print_timeline(&core_timelines[i], time);
+			}
+
+			printf("\n");
+		}
+		printf("Average Waiting Time: %.2f\n", run->waiting_time);
+		printf("Average Turnaround Time: %.2f\n", run->turnaround_time);
+		printf("Average Response Time: %.2f\n", run->response_time);
+
+		if (scheme == EDF || deadlines)
+			print_deadlines(scheduler);
+
+		if (scheme == CFS || scheme == STRIDE || scheme == LOTTERY)
+			print_shares(scheduler);
+
+		if (run->balance || run->stats)
+			print_balance(scheduler);
+
+		if (run->percentiles)
+		{
+			printf("\n");
+			print_percentiles(scheduler);
+		}
+
+		if (run->stats)
+		{
+			printf("\n");
+			print_scheduler_stats(scheduler);
+		}
+	}
+
+	if (run->export_file != NULL && !export_timelines(run->export_file, core_timelines, cores))
+	{
+		fprintf(stderr, "Unable to write file \"%s\".\n", run->export_file);
+		status = 2;
+	}
+
+done:
+	if (run->chrome_file != NULL && !chrome_close(&chrome, time) && status == 0)
+	{
+		fprintf(stderr, "Unable to write file \"%s\".\n", run->chrome_file);
+		status = 2;
+	}
+
+	scheduler_destroy(scheduler);
+
+	priqueue_destroy(&events);
+	free(core_events);
+	free(finished);
+	free(arrivals);
+	free(arriving);
+	free(quantum_clock);
+	for (i=0; i < cores; i++)
+		free(core_timelines[i].segments);
+	free(core_timelines);
+	table_destroy(&table);
+
+	return status;
+}
+
+/*
+ * Sweep workers take the next configuration until none are left.
+ */
+void *sweep_worker(void *arg)
+{
+	simulator_sweep_t *sweep = arg;
+
+	while (1)
+	{
+		pthread_mutex_lock(&sweep->lock);
+		int next = sweep->next_run++;
+		pthread_mutex_unlock(&sweep->lock);
+
+		if (next >= sweep->run_count)
+			break;
+
+		sweep->runs[next].status = simulate(&sweep->runs[next], sweep->trace, 0);
+	}
+
+	return NULL;
+}
+
+/*
+ * Runs every configuration of the sweep on a pool of threads and writes one CSV row per configuration, in order.
+ */
+int run_sweep(simulator_sweep_t *sweep, int threads, const char *csv_name)
+{
+	int i, status = 0;
+
+	if (threads > sweep->run_count)
+		threads = sweep->run_count;
+
+	pthread_t *workers = malloc(threads * sizeof(pthread_t));
+	pthread_mutex_init(&sweep->lock, NULL);
+	sweep->next_run = 0;
+
+	for (i = 0; i < threads; i++)
+		pthread_create(&workers[i], NULL, sweep_worker, sweep);
+	for (i = 0; i < threads; i++)
+		pthread_join(workers[i], NULL);
+
+	pthread_mutex_destroy(&sweep->lock);
+	free(workers);
+
+	FILE *file = (strcmp(csv_name, "-") == 0) ? stdout : fopen(csv_name, "w");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Unable to write file \"%s\".\n", csv_name);
+		return 2;
+	}
+
+	fprintf(file, "scheme,quantum,cores,jobs,waiting,turnaround,response,deadline_misses,max_share_lag,migrations,steals\n");
+	for (i = 0; i < sweep->run_count; i++)
+	{
+		simulator_run_t *run = &sweep->runs[i];
 
-void print_available_cores(int cores)
-{
-	printf("Active cores are: ");
+		if (run->status != 0)
+		{
+			fprintf(stderr, "The %s run on %d core(s) failed.\n", scheme_name(run->scheme), run->cores);
+			status = run->status;
+			continue;
+		}
 
-	int i;
-	for (i = 0; i < cores; i++)
+		fprintf(file, "%s,%d,%d,%d,%.2f,%.2f,%.2f,%llu,%.2f,%llu,%llu\n", scheme_name(run->scheme), run->quantum, run->cores,
+				run->job_count, run->waiting_time, run->turnaround_time, run->response_time, run->deadline_misses,
+				run->max_share_lag, run->migrations, run->steals);
+	}
+
+	if (file != stdout && fclose(file) != 0)
 	{
-		if (i == cores - 1)
-			printf("%d\n", i);
-		else
-			printf("%d, ", i);
+		fprintf(stderr, "Unable to write file \"%s\".\n", csv_name);
+		return 2;
 	}
-}
 
+	return status;
+}
 
 int main(int argc, char **argv)
 {
-	int c;
-	int cores = 0, scheme = -1, quantum = 0;
-	char *file_name;
+	int c, i, j, k;
+	int event_driven = 0, quiet = 0, compact = 0, stream = 0, stats = 0, percentiles = 0, threads = 0;
+	char *file_name, *export_file = NULL, *chrome_file = NULL, *sweep_file = NULL;
+	char *cores_arg = NULL, *schemes_arg = NULL, *quanta_arg = NULL, *levels_arg = NULL;
+	scheduler_config_t config;
+	scheduler_config_init(&config);
 
 	/*
 	 * Parse command line options.
 	 */
-	while ((c = getopt(argc, argv, "c:s:")) != -1)
+	while ((c = getopt(argc, argv, "c:s:eqdlpix:t:Q:M:B:L:G:P:R:W:K:S:j:r:")) != -1)
 	{
 		switch (c)
 		{
 			case 'c':
-				cores = atoi(optarg);
+				cores_arg = optarg;
+				break;
+
+			case 's':
+				schemes_arg = optarg;
+				break;
+
+			case 'e':
+				event_driven = 1;
+				break;
+
+			case 'q':
+				quiet = 1;
+				event_driven = 1;
+				break;
+
+			case 'd':
+				compact = 1;
+				break;
+
+			case 'l':
+				stream = 1;
+				break;
+
+			case 'p':
+				percentiles = 1;
+				break;
+
+			case 'i':
+				stats = 1;
+				break;
+
+			case 'x':
+				export_file = optarg;
+				break;
+
+			case 't':
+				chrome_file = optarg;
+				break;
 
-				if (cores <= 0)
+			case 'Q':
+				if (strcasecmp(optarg, "LIST") == 0) { config.queue_engine = PRIQUEUE_LIST; }
+				else if (strcasecmp(optarg, "HEAP") == 0) { config.queue_engine = PRIQUEUE_HEAP; }
+				else if (strcasecmp(optarg, "TREE") == 0) { config.queue_engine = PRIQUEUE_TREE; }
+				else
 				{
-					fprintf(stderr, "Option -c <cores> require a positive number.\n");
+					fprintf(stderr, "Option -Q <engine> requires list, heap or tree.\n");
 					print_usage(argv[0]);
 					return 1;
 				}
 				break;
 
-			case 's':
-				if (strcasecmp(optarg, "FCFS") == 0) { scheme = FCFS; }
-				else if (strcasecmp(optarg, "SJF") == 0) { scheme = SJF; }
-				else if (strcasecmp(optarg, "PSJF") == 0) { scheme = PSJF; }
-				else if (strcasecmp(optarg, "PRI") == 0) { scheme = PRI; }
-				else if (strcasecmp(optarg, "PPRI") == 0) { scheme = PPRI; }
-				else if (strncasecmp(optarg, "RR", 2) == 0)
+			case 'M':
+				levels_arg = optarg;
+				break;
+
+			case 'B':
+				config.mlfq_boost_period = atoi(optarg);
+
+				if (config.mlfq_boost_period <= 0)
 				{
-					scheme = RR;
-					quantum = atoi(optarg + 2);
+					fprintf(stderr, "Option -B <period> requires a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
 
-					if (quantum <= 0)
-					{
-						fprintf(stderr, "Option -s <scheme> requires a positive number for the quantum of RR. (Eg: -s RR2)\n");
-						print_usage(argv[0]);
-						return 1;
-					}
+			case 'L':
+				config.cfs_latency = atoi(optarg);
+
+				if (config.cfs_latency <= 0)
+				{
+					fprintf(stderr, "Option -L <latency> requires a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'G':
+				config.cfs_granularity = atoi(optarg);
+
+				if (config.cfs_granularity <= 0)
+				{
+					fprintf(stderr, "Option -G <granularity> requires a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'P':
+				config.share_quantum = atoi(optarg);
+
+				if (config.share_quantum <= 0)
+				{
+					fprintf(stderr, "Option -P <quantum> requires a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'R':
+				config.share_seed = strtoull(optarg, NULL, 10);
+				break;
+
+			case 'W':
+				config.work_stealing = 1;
+				config.steal_affinity = atoi(optarg);
+
+				if (config.steal_affinity < 0)
+				{
+					fprintf(stderr, "Option -W <affinity> requires a non-negative number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'K':
+				if (atof(optarg) <= 0)
+				{
+					fprintf(stderr, "Option -K <factor> requires a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+
+				config.deadline_factor = atof(optarg);
+				break;
+
+			case 'S':
+				sweep_file = optarg;
+				break;
+
+			case 'j':
+				threads = atoi(optarg);
+
+				if (threads <= 0)
+				{
+					fprintf(stderr, "Option -j <threads> require a positive number.\n");
+					print_usage(argv[0]);
+					return 1;
 				}
 				break;
 
+			case 'r':
+				quanta_arg = optarg;
+				break;
+
 			case '?':
 				print_usage(argv[0]);
 				return 1;
@@ -128,14 +1624,14 @@ int main(int argc, char **argv)
 		}
 	}
 
-	if (cores == 0)
+	if (cores_arg == NULL)
 	{
 		fprintf(stderr, "Required option -c <cores> is not present.\n");
 		print_usage(argv[0]);
 		return 1;
 	}
 
-	if (scheme == -1)
+	if (schemes_arg == NULL)
 	{
 		fprintf(stderr, "Required option -s <scheme> is not present.\n");
 		print_usage(argv[0]);
@@ -151,337 +1647,185 @@ int main(int argc, char **argv)
 		return 1;
 	}
 
-
 	/*
-	 * Open the file, read the file, and populate the jobs data structure.
+	 * Expand the core counts, schemes and RR quanta into the configurations to run.
 	 */
-	FILE *file = fopen(file_name, "r");
-	if (file == NULL)
+	int core_list[MAX_SWEEP_VALUES], core_count = parse_number_list(cores_arg, core_list, MAX_SWEEP_VALUES);
+	int quanta[MAX_SWEEP_VALUES], quantum_count = 0;
+
+	if (core_count == 0)
 	{
-		fprintf(stderr, "Unable to open file \"%s\".\n", file_name);
-		return 2;
+		fprintf(stderr, "Option -c <cores> require a positive number.\n");
+		print_usage(argv[0]);
+		return 1;
 	}
 
-
-	int job_id = 0;
-	int jobs_ct = 10;
-	simulator_job_list_t* jobs = malloc(jobs_ct * sizeof(simulator_job_list_t));
-
-	char line[1024 + 1];
-	fgets(line, 1024, file);  // Ignore the first (header) line
-	while (fgets(line, 1024, file) != NULL)
+	if (quanta_arg != NULL && (quantum_count = parse_number_list(quanta_arg, quanta, MAX_SWEEP_VALUES)) == 0)
 	{
-		char *arrival_time = strtok(line, ",");
-		char *run_time = strtok(NULL, ",");
-		char *priority = strtok(NULL, ",");
-
-		if (arrival_time != NULL && run_time != NULL && priority != NULL)
-		{
-			if (job_id == jobs_ct)
-			{
-				jobs_ct *= 2;
-				jobs = realloc(jobs, jobs_ct * sizeof(simulator_job_list_t));
-
-				if (!jobs)
-				{
-					fprintf(stderr, "Out of memory.\n");
-					return 2;
-				}
-			}
+		fprintf(stderr, "Option -r <quanta> requires positive numbers.\n");
+		print_usage(argv[0]);
+		return 1;
+	}
 
-			jobs[job_id].job_id = job_id;
-			jobs[job_id].arrival_time = atoi(arrival_time);
-			jobs[job_id].run_time = atoi(run_time);
-			jobs[job_id].priority = atoi(priority);
-			jobs[job_id].core_id = -1;
-			jobs[job_id].arrived = 0;
+	if (levels_arg != NULL)
+	{
+		config.mlfq_levels = parse_number_list(levels_arg, config.mlfq_quanta, SCHEDULER_MLFQ_LEVELS);
 
-			job_id++;
-		}
-		else
+		if (config.mlfq_levels == 0)
 		{
-			fprintf(stderr, "Illegal file format.\n");
-			return 2;
+			fprintf(stderr, "Option -M <quanta> requires 1 to %d positive numbers.\n", SCHEDULER_MLFQ_LEVELS);
+			print_usage(argv[0]);
+			return 1;
 		}
 	}
 
-	fclose(file);
-
-
-	/*
-	 * Run the simulation.
-	 */
-
-	printf("Loaded %d core(s) and %d job(s) using ", cores, job_id);
-	if (scheme == FCFS) { printf("First Come First Served (FCFS)"); }
-	else if (scheme == SJF) { printf("Non-preemptive Shortest Job First (SJF)"); }
-	else if (scheme == PSJF) { printf("Preemptive Shortest Job First (PSJF)"); }
-	else if (scheme == PRI) { printf("Non-preemptive Priority (PRI)"); }
-	else if (scheme == PPRI) { printf("Preemptive Priority (PPRI)"); }
-	else if (scheme == RR) { printf("Round Robin (RR) with a quantum of %d", quantum); }
-	printf(" scheduling...\n\n");
-
-	scheduler_start_up(cores, scheme);
-
-
-	int time = 0, i, j;
-	int active_jobs = job_id, jobs_alive = 0;
-
-	int *quantum_clock = malloc(cores * sizeof(int));
-	char **core_timing_diagram = malloc(cores * sizeof(char *));
-	int core_timing_diagram_size = 1024;
-
-	for (i = 0; i < cores; i++)
-	{
-		quantum_clock[i] = -1;
-		core_timing_diagram[i] = malloc(core_timing_diagram_size + 1);
-		core_timing_diagram[i][0] = '\0';
-	}
+	int scheme_list[MAX_SWEEP_VALUES], scheme_quanta[MAX_SWEEP_VALUES], scheme_count = 0;
+	char *token, *save;
 
-	while (active_jobs > 0)
+	for (token = strtok_r(schemes_arg, ",", &save); token != NULL; token = strtok_r(NULL, ",", &save))
 	{
-		printf("=== [TIME %d] ===\n", time);
+		int scheme, quantum;
 
-		/*
-		 * 1. Check if any jobs finished in the last time unit.
-		 */
-		for (i = 0; i < active_jobs; i++)
+		if (!parse_scheme(token, &scheme, &quantum))
 		{
-			if (jobs[i].run_time == 0)
-			{
-				// Notify the scheduler has finished
-				int job_id = jobs[i].job_id;
-				int core_id = jobs[i].core_id;
-				int new_job_id = scheduler_job_finished(jobs[i].core_id, jobs[i].job_id, time);
-
-				if (scheme == RR)
-					quantum_clock[jobs[i].core_id] = quantum;
-
-				// Delete the finished jobs, decrease the number of active jobs
-				if (i != active_jobs - 1)
-					memcpy(&jobs[i], &jobs[active_jobs - 1], sizeof(simulator_job_list_t));
-				active_jobs--;
-				jobs_alive--;
-				i--;
-
-				// Set the new job
-				if ( new_job_id != -1 && !set_active_job(new_job_id, core_id, jobs, active_jobs) )
-				{
-					printf("The scheduler_job_finished() selected an invalid job (job_id == %d).\n", new_job_id);
-					print_available_jobs(jobs, active_jobs);
-					return 3;
-				}
-				else
-				{
-					printf("Job %d, running on core %d, finished. Core %d is now running job %d.\n", job_id, core_id, core_id, new_job_id);
-					printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
-				}
-			}
+			fprintf(stderr, "Unknown scheme \"%s\".\n", token);
+			print_usage(argv[0]);
+			return 1;
 		}
 
-		/*
-		 * Check to see if we finished our last job.  (If we don't check here, we would run an extra time unit that will be totally idle.)
-		 */
-		if (active_jobs == 0)
-			break;
+		// A bare rr takes every quantum of -r
+		int bare = (scheme == RR && quantum <= 0);
+		int expand = bare ? quantum_count : 1;
 
-		/*
-		 * 2. Check of any quantums expired in the last time unit.
-		 */
-		if (scheme == RR)
+		if (bare && quantum_count == 0)
 		{
-			for (i = 0; i < cores; i++)
-			{
-				if (quantum_clock[i] == 0)
-				{
-					for (j = 0; j < active_jobs; j++)
-					{
-						if (jobs[j].core_id == i)
-						{
-							// Notify the scheduler the quantum has expired
-							int core_id = jobs[j].core_id;
-							int old_job_id = jobs[j].job_id;
-							int new_job_id = scheduler_quantum_expired(jobs[j].core_id, time);
-
-							jobs[j].core_id = -1;
-
-							quantum_clock[core_id] = quantum;
-
-							// Set the new job
-							if ( new_job_id != -1 && !set_active_job(new_job_id, core_id, jobs, active_jobs) )
-							{
-								printf("The scheduler_quantum_expired() selected an invalid job (job_id == %d).\n", new_job_id);
-								print_available_jobs(jobs, active_jobs);
-								return 3;
-							}
-							else
-							{
-								printf("Job %d, running on core %d, had its quantum expire. Core %d is now running job %d.\n", old_job_id, core_id, core_id, new_job_id);
-								printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
-							}
-
-							break;
-						}
-					}
-				}
-			}
+			fprintf(stderr, "Option -s <scheme> requires a positive number for the quantum of RR. (Eg: -s RR2)\n");
+			print_usage(argv[0]);
+			return 1;
 		}
 
-
-		/*
-		 * 3. Check for any new jobs that arrive in this time unit
-		 */
-		for (i = 0; i < active_jobs; i++)
+		for (k = 0; k < expand; k++)
 		{
-			if (jobs[i].arrival_time == time)
+			if (scheme_count == MAX_SWEEP_VALUES)
 			{
-				int new_job_core_id = scheduler_new_job(jobs[i].job_id, time, jobs[i].run_time, jobs[i].priority);
-				jobs[i].arrived = 1;
-				jobs_alive++;
-
-				if (new_job_core_id >= 0 && new_job_core_id < cores)
-				{
-					printf("A new job, job %d (running time=%d, priority=%d), arrived. Job %d is now running on core %d.\n",
-							jobs[i].job_id, jobs[i].run_time, jobs[i].priority, jobs[i].job_id, new_job_core_id);
-					printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
-
-					// Find if anyone is currently using the core.
-					for (j = 0; j < active_jobs; j++)
-						if (jobs[j].core_id == new_job_core_id)
-							jobs[j].core_id = -1;
-
-					// Assign the core to the new job
-					jobs[i].core_id = new_job_core_id;
-
-					if (scheme == RR)
-						quantum_clock[new_job_core_id] = quantum;
-				}
-				else if (new_job_core_id == -1)
-				{
-					printf("A new job, job %d (running time=%d, priority=%d), arrived. Job %d is set to idle (-1).\n",
-							jobs[i].job_id, jobs[i].run_time, jobs[i].priority, jobs[i].job_id);
-					printf("  Queue: "); scheduler_show_queue(); printf("\n\n");
-				}
-				else
-				{
-					printf("The scheduler_new_job() selected an invalid core (core_id == %d).\n", new_job_core_id);
-					print_available_cores(cores);
-					return 3;
-				}
+				fprintf(stderr, "Option -s <scheme> accepts at most %d schemes.\n", MAX_SWEEP_VALUES);
+				return 1;
 			}
+
+			scheme_list[scheme_count] = scheme;
+			scheme_quanta[scheme_count] = bare ? quanta[k] : quantum;
+			scheme_count++;
 		}
+	}
 
+	if (sweep_file == NULL && (core_count > 1 || scheme_count > 1))
+	{
+		fprintf(stderr, "Lists of cores or schemes require a sweep (-S <file>).\n");
+		print_usage(argv[0]);
+		return 1;
+	}
 
-		/*
-		 * 4. Run the time unit.
-		 */
-		char time_string[cores][11];
-		int cores_working = 0;
 
-		for (i = 0; i < cores; i++)
-			time_string[i][0] = '\0';
+	/*
+	 * All output goes through one large buffer, flushed at exit.
+	 */
+	static char output_buffer[1 << 20];
+	setvbuf(stdout, output_buffer, _IOFBF, sizeof(output_buffer));
 
-		for (i = 0; i < active_jobs; i++)
-		{
-			if (jobs[i].core_id != -1)
-			{
-				cores_working++;
-				jobs[i].run_time--;
-				quantum_clock[jobs[i].core_id]--;
 
-				assert(time_string[jobs[i].core_id][0] == '\0');
+	/*
+	 * Map the file; jobs are read from it as the simulation reaches them.
+	 */
+	trace_t trace;
+	if (!trace_open(&trace, file_name))
+	{
+		fprintf(stderr, "Unable to open file \"%s\".\n", file_name);
+		return 2;
+	}
 
-				if (jobs[i].job_id < 10)
-					sprintf(time_string[jobs[i].core_id], "%d", jobs[i].job_id);
-				else if (jobs[i].job_id < 10 + 26)
-					sprintf(time_string[jobs[i].core_id], "%c", jobs[i].job_id - 10 + 'a');
-				else if (jobs[i].job_id < 10 + 26 + 26)
-					sprintf(time_string[jobs[i].core_id], "%c", jobs[i].job_id - 10 - 26 + 'A');
-				else
-					snprintf(time_string[jobs[i].core_id], 10, "(%d)", jobs[i].job_id);
-			}
-		}
 
-		for (i = 0; i < cores; i++)
-		{
-			// If the core is idle, print a '-'
-			if (time_string[i][0] == '\0')
-				strcpy(time_string[i], "-");
+	/*
+	 * Sweep every configuration over the shared trace.
+	 */
+	if (sweep_file != NULL)
+	{
+		simulator_sweep_t sweep;
+		sweep.trace = &trace;
+		sweep.run_count = core_count * scheme_count;
+		sweep.runs = calloc(sweep.run_count, sizeof(simulator_run_t));
 
-			// Ensure we have enough memory
-			while (strlen(core_timing_diagram[i]) + strlen(time_string[i]) >= (unsigned int)core_timing_diagram_size)
+		for (i = 0; i < scheme_count; i++)
+		{
+			for (j = 0; j < core_count; j++)
 			{
-				core_timing_diagram_size *= 2;
-
-				for (j = 0; j < cores; j++)
-				{
-					core_timing_diagram[j] = realloc(core_timing_diagram[j], core_timing_diagram_size + 1);
-
-					if (core_timing_diagram[j] == NULL)
-					{
-						fprintf(stderr, "Out of memory.\n");
-						return 3;
-					}
-				}
+				simulator_run_t *run = &sweep.runs[i * core_count + j];
+				run->cores = core_list[j];
+				run->scheme = scheme_list[i];
+				run->quantum = scheme_quanta[i];
+				run->event_driven = 1;
+				run->quiet = 1;
+				run->stream = stream;
+				run->config = &config;
 			}
-
-			strcat( core_timing_diagram[i], time_string[i] );
 		}
 
+		if (threads == 0)
+			threads = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
 
-		/*
-		 * 5. Print data!
-		 */
-		printf("At the end of time unit %d...\n", time);
-
-		for (i = 0; i < cores; i++)
-			printf("  Core %2d: %s\n", i, core_timing_diagram[i]);
-
-		printf("\n");
+		int status = run_sweep(&sweep, threads, sweep_file);
 
-		printf("  Queue: ");
-		scheduler_show_queue();
-		printf("\n");
-		printf("\n");
+		free(sweep.runs);
+		trace_close(&trace);
+		return status;
+	}
 
 
-		/*
-		 * 6. Sanity Checking
-		 *
-		 * - If there's a job alive (needing to be ran) and all CPUs are idle, the scheduler failed to schedule properly.
-		 */
-		if (jobs_alive > 0 && cores_working == 0)
+	/*
+	 * Run the simulation.
+	 */
+	simulator_run_t run;
+	run.cores = core_list[0];
+	run.scheme = scheme_list[0];
+	run.quantum = scheme_quanta[0];
+	run.event_driven = event_driven;
+	run.quiet = quiet;
+	run.compact = compact;
+	run.report = 1;
+	run.stream = stream;
+	run.stats = stats;
+	run.percentiles = percentiles;
+	run.balance = config.work_stealing;
+	run.config = &config;
+	run.export_file = export_file;
+	run.chrome_file = chrome_file;
+
+	if (!quiet)
+	{
+		int job_count = trace_count_jobs(&trace);
+		if (job_count < 0)
 		{
-			printf("All cores are idle and at least one job remains unscheduled.\n");
-			print_available_jobs(jobs, active_jobs);
-			return 3;
+			trace_close(&trace);
+			return 2;
 		}
 
-
-		/*
-		 * 7. Increase time
-		 */
-		time++;
+		printf("Loaded %d core(s) and %d job(s) using ", run.cores, job_count);
+		if (run.scheme == FCFS) { printf("First Come First Served (FCFS)"); }
+		else if (run.scheme == SJF) { printf("Non-preemptive Shortest Job First (SJF)"); }
+		else if (run.scheme == PSJF) { printf("Preemptive Shortest Job First (PSJF)"); }
+		else if (run.scheme == PRI) { printf("Non-preemptive Priority (PRI)"); }
+		else if (run.scheme == PPRI) { printf("Preemptive Priority (PPRI)"); }
+		else if (run.scheme == RR) { printf("Round Robin (RR) with a quantum of %d", run.quantum); }
+		else if (run.scheme == MLFQ) { printf("Multi-Level Feedback Queue (MLFQ)"); }
+		else if (run.scheme == EDF) { printf("Preemptive Earliest Deadline First (EDF)"); }
+		else if (run.scheme == CFS) { printf("Completely Fair Scheduler (CFS)"); }
+		else if (run.scheme == STRIDE) { printf("Stride Scheduling (STRIDE)"); }
+		else if (run.scheme == LOTTERY) { printf("Lottery Scheduling (LOTTERY)"); }
+		printf(" scheduling...\n\n");
 	}
 
+	int status = simulate(&run, &trace, 1);
 
-	printf("FINAL TIMING DIAGRAM:\n");
-	for (i = 0; i < cores; i++)
-		printf("  Core %2d: %s\n", i, core_timing_diagram[i]);
-
-	printf("\n");
-	printf("Average Waiting Time: %.2f\n", scheduler_average_waiting_time());
-	printf("Average Turnaround Time: %.2f\n", scheduler_average_turnaround_time());
-	printf("Average Response Time: %.2f\n", scheduler_average_response_time());
-
-	scheduler_clean_up();
-
-
-	free(quantum_clock);
-	for (i=0; i < cores; i++)
-		free(core_timing_diagram[i]);
-	free(core_timing_diagram);
-	free(jobs);
+	trace_close(&trace);
 
-	return 0;
+	return status;
 }
@@ -0,0 +1,124 @@
+/** @file traceconv.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libtrace/libtrace.h"
+
+void print_usage(char *program_name)
+{
+	fprintf(stderr, "Usage: %s <input file> <output file>\n", program_name);
+	fprintf(stderr, "       %s examples/proc3.csv proc3.trace\n", program_name);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "A CSV input is written as a binary trace, sorted by arrival time; jobs arriving\n");
+	fprintf(stderr, "together keep their CSV order.  A binary input is written back as CSV.\n");
+}
+
+int job_compare(const void *a, const void *b)
+{
+	const trace_job_t *x = a, *y = b;
+
+	if (x->arrival_time != y->arrival_time)
+		return (x->arrival_time < y->arrival_time) ? -1 : 1;
+	return (x->job_id < y->job_id) ? -1 : (x->job_id > y->job_id);
+}
+
+/*
+ * Writes a binary trace as CSV, streaming it through a cursor.
+ */
+int write_csv(const trace_t *trace, FILE *out)
+{
+	trace_cursor_t cursor;
+
+	fprintf(out, "\"Arrival time\",\"Run time\",\"Priority\",\"Deadline\"\n");
+	for (trace_begin(&cursor, trace, 1, 1); cursor.has_next; trace_advance(&cursor))
+	{
+		if (cursor.next.deadline == -1)
+			fprintf(out, "%d,%d,%d\n", cursor.next.arrival_time, cursor.next.run_time, cursor.next.priority);
+		else
+			fprintf(out, "%d,%d,%d,%d\n", cursor.next.arrival_time, cursor.next.run_time, cursor.next.priority, cursor.next.deadline);
+	}
+
+	return cursor.error ? 2 : 0;
+}
+
+/*
+ * Writes a CSV trace as a binary trace.  The CSV need not be sorted, so all of its jobs are loaded and sorted first.
+ */
+int write_binary(const trace_t *trace, FILE *out)
+{
+	trace_cursor_t cursor;
+	int count = 0, capacity = 1024, i;
+	trace_job_t *jobs = malloc(capacity * sizeof(trace_job_t));
+
+	for (trace_begin(&cursor, trace, 0, 1); cursor.has_next; trace_advance(&cursor))
+	{
+		if (count == capacity)
+		{
+			trace_job_t *grown = realloc(jobs, 2 * capacity * sizeof(trace_job_t));
+			if (grown == NULL)
+			{
+				fprintf(stderr, "Out of memory.\n");
+				free(jobs);
+				return 2;
+			}
+
+			jobs = grown;
+			capacity *= 2;
+		}
+
+		jobs[count++] = cursor.next;
+	}
+
+	if (cursor.error)
+	{
+		free(jobs);
+		return 2;
+	}
+
+	qsort(jobs, count, sizeof(trace_job_t), job_compare);
+
+	int ok = trace_write_header(out, count);
+	for (i = 0; i < count && ok; i++)
+		ok = trace_write_job(out, &jobs[i]);
+
+	free(jobs);
+	return ok ? 0 : 2;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 3)
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	trace_t trace;
+	if (!trace_open(&trace, argv[1]))
+	{
+		fprintf(stderr, "Unable to open file \"%s\".\n", argv[1]);
+		return 2;
+	}
+
+	FILE *out = fopen(argv[2], "wb");
+	if (out == NULL)
+	{
+		fprintf(stderr, "Unable to write file \"%s\".\n", argv[2]);
+		trace_close(&trace);
+		return 2;
+	}
+
+	int status = trace.binary ? write_csv(&trace, out) : write_binary(&trace, out);
+
+	if (fclose(out) != 0 && status == 0)
+	{
+		fprintf(stderr, "Unable to write file \"%s\".\n", argv[2]);
+		status = 2;
+	}
+
+	trace_close(&trace);
+	return status;
+}
@@ -0,0 +1,414 @@
+/** @file tracegen.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <limits.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "libtrace/libtrace.h"
+
+#define MAX_PRIORITIES 64
+
+typedef enum {ARRIVE_POISSON = 0, ARRIVE_BURSTY, ARRIVE_DIURNAL} arrival_process_t;
+typedef enum {RUN_EXPONENTIAL = 0, RUN_PARETO, RUN_BIMODAL} run_distribution_t;
+
+typedef struct _generator_t
+{
+	uint64_t state[4];                 // xoshiro256** state
+
+	arrival_process_t arrivals;
+	double rate;                       // mean arrivals per time unit
+	double burst;                      // mean jobs per burst
+	double period, amplitude;          // diurnal cycle
+	double clock;                      // continuous time of the last arrival
+	long burst_left;
+
+	run_distribution_t runs;
+	double mean_run, shape;
+
+	double priority_cdf[MAX_PRIORITIES];
+	int priorities;
+} generator_t;
+
+void print_usage(char *program_name)
+{
+	fprintf(stderr, "Usage: %s -n <jobs> [-o <file>] [-f csv|bin] [-S <seed>]\n", program_name);
+	fprintf(stderr, "          [-a poisson|bursty|diurnal] [-r <rate>] [-b <burst>] [-p <period>] [-A <amplitude>]\n");
+	fprintf(stderr, "          [-t exp|pareto|bimodal] [-m <mean>] [-k <shape>] [-P <w0,w1,...>]\n");
+	fprintf(stderr, "       %s -n 1000000 -a bursty -t pareto -f bin -o big.trace\n", program_name);
+	fprintf(stderr, "\n");
+	fprintf(stderr, "  -n  number of jobs, up to %d\n", INT_MAX);
+	fprintf(stderr, "  -o  output file (default: stdout)\n");
+	fprintf(stderr, "  -f  csv (default) or bin, the binary trace format of traceconv\n");
+	fprintf(stderr, "  -S  seed; the same seed and options give the same trace (default: 1)\n");
+	fprintf(stderr, "  -a  arrival process (default: poisson)\n");
+	fprintf(stderr, "        poisson  exponential gaps between arrivals\n");
+	fprintf(stderr, "        bursty   Poisson bursts of geometric size -b, arriving together\n");
+	fprintf(stderr, "        diurnal  Poisson with a rate that follows a sine of period -p and relative amplitude -A\n");
+	fprintf(stderr, "  -r  mean arrivals per time unit (default: 0.5)\n");
+	fprintf(stderr, "  -b  mean jobs per burst (default: 20)\n");
+	fprintf(stderr, "  -p  diurnal period in time units (default: 1440)\n");
+	fprintf(stderr, "  -A  diurnal amplitude, from 0 to 1 (default: 0.8)\n");
+	fprintf(stderr, "  -t  running time distribution (default: exp)\n");
+	fprintf(stderr, "        exp      exponential\n");
+	fprintf(stderr, "        pareto   heavy-tailed Pareto of shape -k\n");
+	fprintf(stderr, "        bimodal  90%% short jobs around mean/2, 10%% long ones around 5.5 x mean\n");
+	fprintf(stderr, "  -m  mean running time (default: 10)\n");
+	fprintf(stderr, "  -k  Pareto shape, above 1 (default: 1.5)\n");
+	fprintf(stderr, "  -P  relative weights of priorities 0, 1, ... (default: 1,1,1,1,1)\n");
+}
+
+uint64_t rotl(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+/*
+ * Next 64 random bits, from xoshiro256**.
+ */
+uint64_t next_bits(generator_t *g)
+{
+	uint64_t *s = g->state;
+	uint64_t result = rotl(s[1] * 5, 7) * 9;
+	uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+
+	return result;
+}
+
+/*
+ * Seeds the state through splitmix64, so that nearby seeds give unrelated streams.
+ */
+void seed_generator(generator_t *g, uint64_t seed)
+{
+	int i;
+	for (i = 0; i < 4; i++)
+	{
+		uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		g->state[i] = z ^ (z >> 31);
+	}
+}
+
+/*
+ * Uniform in (0, 1).
+ */
+double uniform(generator_t *g)
+{
+	return ((next_bits(g) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+double exponential(generator_t *g, double mean)
+{
+	return -mean * log(uniform(g));
+}
+
+/*
+ * Continuous time of the next arrival.
+ */
+double next_arrival(generator_t *g)
+{
+	switch (g->arrivals)
+	{
+		case ARRIVE_BURSTY:
+			// Bursts arrive as a Poisson process and all of a burst's jobs arrive with it
+			if (g->burst_left == 0)
+			{
+				g->clock += exponential(g, g->burst / g->rate);
+				g->burst_left = 1 + (long)floor(log(uniform(g)) / log(1.0 - 1.0 / g->burst));
+			}
+			g->burst_left--;
+			return g->clock;
+
+		case ARRIVE_DIURNAL:
+			// Thinning: candidates at the peak rate, kept in proportion to the rate at their time
+			while (1)
+			{
+				double peak = g->rate * (1.0 + g->amplitude);
+				g->clock += exponential(g, 1.0 / peak);
+
+				double rate = g->rate * (1.0 + g->amplitude * sin(2.0 * M_PI * g->clock / g->period));
+				if (uniform(g) * peak <= rate)
+					return g->clock;
+			}
+
+		default:
+			g->clock += exponential(g, 1.0 / g->rate);
+			return g->clock;
+	}
+}
+
+/*
+ * A running time of at least one time unit.
+ */
+int next_run_time(generator_t *g)
+{
+	double run;
+
+	switch (g->runs)
+	{
+		case RUN_PARETO:
+		{
+			double scale = g->mean_run * (g->shape - 1.0) / g->shape;
+			run = scale / pow(uniform(g), 1.0 / g->shape);
+			break;
+		}
+
+		case RUN_BIMODAL:
+			if (uniform(g) < 0.9)
+				run = exponential(g, g->mean_run * 0.5);
+			else
+				run = exponential(g, g->mean_run * 5.5);
+			break;
+
+		default:
+			run = exponential(g, g->mean_run);
+			break;
+	}
+
+	if (run >= INT_MAX)
+		return INT_MAX;
+	return (run < 1.5) ? 1 : (int)lround(run);
+}
+
+int next_priority(generator_t *g)
+{
+	double u = uniform(g);
+	int i;
+
+	for (i = 0; i < g->priorities - 1; i++)
+		if (u < g->priority_cdf[i])
+			return i;
+
+	return g->priorities - 1;
+}
+
+/*
+ * Parses the priority weights into a cumulative distribution.
+ */
+int parse_priorities(generator_t *g, char *list)
+{
+	double total = 0;
+	char *token, *save;
+
+	g->priorities = 0;
+	for (token = strtok_r(list, ",", &save); token != NULL; token = strtok_r(NULL, ",", &save))
+	{
+		double weight = atof(token);
+		if (g->priorities == MAX_PRIORITIES || weight < 0)
+			return 0;
+
+		total += weight;
+		g->priority_cdf[g->priorities++] = total;
+	}
+
+	if (g->priorities == 0 || total <= 0)
+		return 0;
+
+	int i;
+	for (i = 0; i < g->priorities; i++)
+		g->priority_cdf[i] /= total;
+
+	return 1;
+}
+
+/*
+ * Appends the decimal form of value to *out.
+ */
+void put_int(char **out, int value)
+{
+	char digits[12];
+	int length = 0;
+	unsigned int v = (value < 0) ? -(unsigned int)value : (unsigned int)value;
+
+	do
+	{
+		digits[length++] = '0' + v % 10;
+		v /= 10;
+	} while (v > 0);
+
+	if (value < 0)
+		*(*out)++ = '-';
+	while (length > 0)
+		*(*out)++ = digits[--length];
+}
+
+int main(int argc, char **argv)
+{
+	int c;
+	long jobs = -1;
+	int binary = 0;
+	uint64_t seed = 1;
+	char *output_name = NULL;
+	char default_priorities[] = "1,1,1,1,1";
+	char *priorities = default_priorities;
+
+	generator_t g;
+	memset(&g, 0, sizeof(g));
+	g.arrivals = ARRIVE_POISSON;
+	g.rate = 0.5;
+	g.burst = 20;
+	g.period = 1440;
+	g.amplitude = 0.8;
+	g.runs = RUN_EXPONENTIAL;
+	g.mean_run = 10;
+	g.shape = 1.5;
+
+	while ((c = getopt(argc, argv, "n:o:f:S:a:r:b:p:A:t:m:k:P:")) != -1)
+	{
+		switch (c)
+		{
+			case 'n': jobs = atol(optarg); break;
+			case 'o': output_name = optarg; break;
+			case 'S': seed = strtoull(optarg, NULL, 10); break;
+			case 'r': g.rate = atof(optarg); break;
+			case 'b': g.burst = atof(optarg); break;
+			case 'p': g.period = atof(optarg); break;
+			case 'A': g.amplitude = atof(optarg); break;
+			case 'm': g.mean_run = atof(optarg); break;
+			case 'k': g.shape = atof(optarg); break;
+			case 'P': priorities = optarg; break;
+
+			case 'f':
+				if (strcasecmp(optarg, "CSV") == 0) { binary = 0; }
+				else if (strcasecmp(optarg, "BIN") == 0) { binary = 1; }
+				else
+				{
+					fprintf(stderr, "Option -f <format> requires csv or bin.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'a':
+				if (strcasecmp(optarg, "POISSON") == 0) { g.arrivals = ARRIVE_POISSON; }
+				else if (strcasecmp(optarg, "BURSTY") == 0) { g.arrivals = ARRIVE_BURSTY; }
+				else if (strcasecmp(optarg, "DIURNAL") == 0) { g.arrivals = ARRIVE_DIURNAL; }
+				else
+				{
+					fprintf(stderr, "Option -a <process> requires poisson, bursty or diurnal.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 't':
+				if (strcasecmp(optarg, "EXP") == 0) { g.runs = RUN_EXPONENTIAL; }
+				else if (strcasecmp(optarg, "PARETO") == 0) { g.runs = RUN_PARETO; }
+				else if (strcasecmp(optarg, "BIMODAL") == 0) { g.runs = RUN_BIMODAL; }
+				else
+				{
+					fprintf(stderr, "Option -t <distribution> requires exp, pareto or bimodal.\n");
+					print_usage(argv[0]);
+					return 1;
+				}
+				break;
+
+			default:
+				print_usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if (jobs < 0 || jobs > INT_MAX)
+	{
+		fprintf(stderr, "Required option -n <jobs> needs a number from 0 to %d.\n", INT_MAX);
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	if (g.rate <= 0 || g.burst < 1 || g.period <= 0 || g.amplitude < 0 || g.amplitude > 1 || g.mean_run < 1 || g.shape <= 1)
+	{
+		fprintf(stderr, "Options need -r > 0, -b >= 1, -p > 0, 0 <= -A <= 1, -m >= 1 and -k > 1.\n");
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	if (!parse_priorities(&g, priorities))
+	{
+		fprintf(stderr, "Option -P <weights> requires up to %d non-negative weights, not all zero.\n", MAX_PRIORITIES);
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	if (optind != argc)
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	FILE *out = (output_name == NULL) ? stdout : fopen(output_name, "wb");
+	if (out == NULL)
+	{
+		fprintf(stderr, "Unable to write file \"%s\".\n", output_name);
+		return 2;
+	}
+
+	static char output_buffer[1 << 20];
+	setvbuf(out, output_buffer, _IOFBF, sizeof(output_buffer));
+
+	seed_generator(&g, seed);
+
+	int ok = binary ? trace_write_header(out, jobs) : (fputs("\"Arrival time\",\"Run time\",\"Priority\"\n", out) >= 0);
+	long i;
+
+	for (i = 0; i < jobs && ok; i++)
+	{
+		trace_job_t job;
+		double arrival = floor(next_arrival(&g));
+
+		if (arrival > INT_MAX)
+		{
+			fprintf(stderr, "Job %ld arrives after time %d; raise the rate (-r).\n", i, INT_MAX);
+			ok = 0;
+			break;
+		}
+
+		job.job_id = i;
+		job.arrival_time = (int)arrival;
+		job.run_time = next_run_time(&g);
+		job.priority = next_priority(&g);
+		job.deadline = -1;
+
+		if (binary)
+			ok = trace_write_job(out, &job);
+		else
+		{
+			char line[48], *end = line;
+
+			put_int(&end, job.arrival_time);
+			*end++ = ',';
+			put_int(&end, job.run_time);
+			*end++ = ',';
+			put_int(&end, job.priority);
+			*end++ = '\n';
+
+			ok = (fwrite(line, end - line, 1, out) == 1);
+		}
+	}
+
+	if (fflush(out) != 0)
+		ok = 0;
+	if (out != stdout && fclose(out) != 0)
+		ok = 0;
+
+	if (!ok)
+	{
+		fprintf(stderr, "Unable to write the trace.\n");
+		return 2;
+	}
+
+	return 0;
+}